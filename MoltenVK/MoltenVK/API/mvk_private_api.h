@@ -44,7 +44,7 @@ typedef unsigned long MTLArgumentBuffersTier;
  */
 
 
-#define MVK_PRIVATE_API_VERSION   43
+#define MVK_PRIVATE_API_VERSION   44
 
 
 #pragma mark -
@@ -247,6 +247,13 @@ typedef struct {
 	const char* shaderDumpDir;                                                 /**< MVK_CONFIG_SHADER_DUMP_DIR */
 	VkBool32 shaderLogEstimatedGLSL;                                           /**< MVK_CONFIG_SHADER_LOG_ESTIMATED_GLSL */
 	VkBool32 liveCheckAllResources;                                            /**< MVK_CONFIG_LIVE_CHECK_ALL_RESOURCES */
+	VkBool32 compactRecordedCommands;                                          /**< MVK_CONFIG_COMPACT_RECORDED_COMMANDS */
+	VkBool32 cacheDynamicRenderingObjects;                                     /**< MVK_CONFIG_CACHE_DYNAMIC_RENDERING_OBJECTS */
+	const char* helperPipelineManifestPath;                                    /**< MVK_CONFIG_HELPER_PIPELINE_MANIFEST_PATH */
+	uint64_t deviceMemorySuballocationMaxSize;                                 /**< MVK_CONFIG_DEVICE_MEMORY_SUBALLOCATION_MAX_SIZE */
+	uint64_t queueSubmissionBatchingTimeout;                                   /**< MVK_CONFIG_QUEUE_SUBMISSION_BATCHING_TIMEOUT */
+	uint32_t swapchainMaxFramesInFlight;                                       /**< MVK_CONFIG_SWAPCHAIN_MAX_FRAMES_IN_FLIGHT */
+	VkBool32 createPipelinesConcurrently;                                      /**< MVK_CONFIG_CREATE_PIPELINES_CONCURRENTLY */
 } MVKConfiguration;
 
 // Legacy support for renamed struct elements.
@@ -304,13 +311,29 @@ typedef struct {
 	MVKPerformanceTracker waitPresentSwapchains;		/** Wait time from vkQueuePresentKHR() call to starting the encoding of the swapchains to the GPU, in milliseconds. Useful when MVK_CONFIG_SYNCHRONOUS_QUEUE_SUBMITS is disabled. */
 	MVKPerformanceTracker presentSwapchains;            /** Present the swapchains in a vkQueuePresentKHR() on the GPU, from commit to presentation callback, in milliseconds. */
 	MVKPerformanceTracker frameInterval;                /** Frame presentation interval (1000/FPS), in milliseconds. */
+	MVKPerformanceTracker submissionsBatched;           /** Number of vkQueueSubmit() submissions merged into a batch with preceding submissions, when MVK_CONFIG_QUEUE_SUBMISSION_BATCHING_TIMEOUT is enabled. */
+	MVKPerformanceTracker activeMTLCommandBuffers;      /** Number of MTLCommandBuffers active on the queue, including the one being retrieved, each time a MTLCommandBuffer is retrieved. */
+	MVKPerformanceTracker waitFramePacing;              /** Wait time in vkAcquireNextImageKHR() for the number of frames in flight to drop below MVK_CONFIG_SWAPCHAIN_MAX_FRAMES_IN_FLIGHT, in milliseconds. */
 } MVKQueuePerformance;
 
 /** MoltenVK performance of device activities. */
 typedef struct {
 	MVKPerformanceTracker gpuMemoryAllocated;		/** GPU memory allocated, in kilobytes. */
+	MVKPerformanceTracker hostMemoryPoolAllocated;	/** Host memory allocated by the host memory pool backing device memory, including idle blocks, in kilobytes. The maximum is the high-water mark. */
+	MVKPerformanceTracker hostMemoryPoolReuses;		/** Number of device memory host backing allocations that reused an idle block from the host memory pool. */
 } MVKDevicePerformance;
 
+/** MoltenVK performance of command buffer recording activities. */
+typedef struct {
+	MVKPerformanceTracker redundantViewportsCompacted;		/** Number of vkCmdSetViewport() commands dropped or merged while recording a VkCommandBuffer. */
+	MVKPerformanceTracker redundantScissorsCompacted;		/** Number of vkCmdSetScissor() commands dropped or merged while recording a VkCommandBuffer. */
+	MVKPerformanceTracker redundantPipelineBindsCompacted;	/** Number of vkCmdBindPipeline() commands dropped while recording a VkCommandBuffer. */
+	MVKPerformanceTracker pushConstantBytesUploaded;		/** Number of push constant bytes uploaded to Metal while encoding a VkCommandBuffer. */
+	MVKPerformanceTracker copyRegionsCoalesced;				/** Number of copy regions, buffer updates, and query result copies merged into others while recording a VkCommandBuffer. */
+	MVKPerformanceTracker helperPipelineWarmupHits;			/** Number of helper pipeline states first used by a command after being created by the background warm-up from the helper pipeline manifest. */
+	MVKPerformanceTracker helperPipelineWarmupMisses;		/** Number of helper pipeline states that had to be created when first used by a command, while the helper pipeline manifest is enabled. */
+} MVKCommandBufferPerformance;
+
 /**
  * MoltenVK performance. You can retrieve a copy of this structure using the vkGetPerformanceStatisticsMVK() function.
  *
@@ -325,6 +348,7 @@ typedef struct {
 	MVKPipelineCachePerformance pipelineCache;			/** Pipeline cache activities. */
 	MVKQueuePerformance queue;          				/** Queue activities. */
 	MVKDevicePerformance device;          				/** Device activities. */
+	MVKCommandBufferPerformance commandBuffer;			/** Command buffer recording and encoding activities. */
 } MVKPerformanceStatistics;
 
 
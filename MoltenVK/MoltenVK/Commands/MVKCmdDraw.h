@@ -30,12 +30,19 @@
 
 /**
  * Vulkan command to bind buffers containing vertex content.
- * Template class to balance vector pre-allocations between very common low counts and fewer larger counts.
+ * The buffer bindings are stored inline after the command.
  */
-template <size_t N>
-class MVKCmdBindVertexBuffers : public MVKCommand {
+class MVKCmdBindVertexBuffers : public MVKInlineCommand {
 
 public:
+	static MVKCmdBindVertexBuffers* newCommand(MVKCommandBuffer* cmdBuff,
+											   uint32_t firstBinding,
+											   uint32_t bindingCount,
+											   const VkBuffer* pBuffers,
+											   const VkDeviceSize* pOffsets,
+											   const VkDeviceSize* pSizes,
+											   const VkDeviceSize* pStrides);
+
 	VkResult setContent(MVKCommandBuffer* cmdBuff,
 						uint32_t firstBinding,
 						uint32_t bindingCount,
@@ -47,17 +54,12 @@ public:
     void encode(MVKCommandEncoder* cmdEncoder) override;
 
 protected:
-	MVKCommandTypePool<MVKCommand>* getTypePool(MVKCommandPool* cmdPool) override;
+	friend class MVKInlineObjectConstructor<MVKCmdBindVertexBuffers>;
 
+	MVKInlineArray<MVKVertexMTLBufferBinding> _bindings;
 	uint32_t _firstBinding;
-    MVKSmallVector<MVKVertexMTLBufferBinding, N> _bindings;
 };
 
-// Concrete template class implementations.
-typedef MVKCmdBindVertexBuffers<1> MVKCmdBindVertexBuffers1;
-typedef MVKCmdBindVertexBuffers<2> MVKCmdBindVertexBuffers2;
-typedef MVKCmdBindVertexBuffers<8> MVKCmdBindVertexBuffersMulti;
-
 
 #pragma mark -
 #pragma mark MVKCmdBindIndexBuffer
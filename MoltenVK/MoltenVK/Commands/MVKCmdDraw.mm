@@ -21,6 +21,7 @@
 #include "MVKCommandPool.h"
 #include "MVKBuffer.h"
 #include "MVKPipeline.h"
+#include "MVKInlineObjectConstructor.h"
 #include "MVKFoundation.h"
 #include "mvk_datatypes.hpp"
 
@@ -28,37 +29,45 @@
 #pragma mark -
 #pragma mark MVKCmdBindVertexBuffers
 
-template <size_t N>
-VkResult MVKCmdBindVertexBuffers<N>::setContent(MVKCommandBuffer* cmdBuff,
-												uint32_t firstBinding,
-												uint32_t bindingCount,
-												const VkBuffer* pBuffers,
-												const VkDeviceSize* pOffsets,
-												const VkDeviceSize* pSizes,
-												const VkDeviceSize* pStrides) {
+MVKCmdBindVertexBuffers* MVKCmdBindVertexBuffers::newCommand(MVKCommandBuffer* cmdBuff,
+															 uint32_t firstBinding,
+															 uint32_t bindingCount,
+															 const VkBuffer* pBuffers,
+															 const VkDeviceSize* pOffsets,
+															 const VkDeviceSize* pSizes,
+															 const VkDeviceSize* pStrides) {
+	using Constructor = MVKInlineObjectConstructor<MVKCmdBindVertexBuffers>;
+	return Constructor::CreateWithAllocator(
+		[cmdBuff](size_t byteCount) { return cmdBuff->allocateCommandStorage(byteCount); },
+		std::tuple {
+			Constructor::Init(&MVKCmdBindVertexBuffers::_bindings, bindingCount),
+		}
+	);
+}
+
+VkResult MVKCmdBindVertexBuffers::setContent(MVKCommandBuffer* cmdBuff,
+											 uint32_t firstBinding,
+											 uint32_t bindingCount,
+											 const VkBuffer* pBuffers,
+											 const VkDeviceSize* pOffsets,
+											 const VkDeviceSize* pSizes,
+											 const VkDeviceSize* pStrides) {
 	_firstBinding = firstBinding;
-	_bindings.clear();	// Clear for reuse
-    _bindings.reserve(bindingCount);
-    MVKVertexMTLBufferBinding b;
-    for (uint32_t bindIdx = 0; bindIdx < bindingCount; bindIdx++) {
-        MVKBuffer* mvkBuffer = (MVKBuffer*)pBuffers[bindIdx];
-        b.mtlBuffer = mvkBuffer->getMTLBuffer();
-        b.offset = mvkBuffer->getMTLBufferOffset() + pOffsets[bindIdx];
+	for (uint32_t bindIdx = 0; bindIdx < bindingCount; bindIdx++) {
+		MVKBuffer* mvkBuffer = (MVKBuffer*)pBuffers[bindIdx];
+		auto& b = _bindings[bindIdx];
+		b.mtlBuffer = mvkBuffer->getMTLBuffer();
+		b.offset = mvkBuffer->getMTLBufferOffset() + pOffsets[bindIdx];
 		b.size = pSizes ? uint32_t(pSizes[bindIdx] == VK_WHOLE_SIZE ? mvkBuffer->getByteCount() - pOffsets[bindIdx] : pSizes[bindIdx]) : 0;
 		b.stride = pStrides ? (uint32_t)pStrides[bindIdx] : 0;
-        _bindings.push_back(b);
-    }
+	}
 
 	return VK_SUCCESS;
 }
-template <size_t N>
-void MVKCmdBindVertexBuffers<N>::encode(MVKCommandEncoder* cmdEncoder) {
-	cmdEncoder->getState().bindVertexBuffers(_firstBinding, _bindings.contents());
-}
 
-template class MVKCmdBindVertexBuffers<1>;
-template class MVKCmdBindVertexBuffers<2>;
-template class MVKCmdBindVertexBuffers<8>;
+void MVKCmdBindVertexBuffers::encode(MVKCommandEncoder* cmdEncoder) {
+	cmdEncoder->getState().bindVertexBuffers(_firstBinding, _bindings);
+}
 
 
 #pragma mark -
@@ -110,6 +110,12 @@ public:
 
 	virtual bool isTessellationPipeline() { return false; };
 
+	/** Returns whether binding the pipeline changes the color attachment locations of the current renderpass. */
+	virtual bool hasRemappedAttachmentLocations() { return false; };
+
+	/** Returns the pipeline bound by this command. */
+	MVKPipeline* getPipeline() { return _pipeline; }
+
 protected:
 	MVKPipeline* _pipeline;
 
@@ -124,8 +130,12 @@ class MVKCmdBindGraphicsPipeline : public MVKCmdBindPipeline {
 public:
 	void encode(MVKCommandEncoder* cmdEncoder) override;
 
+	MVKCommandCompaction getCompaction(MVKCommandBuffer* cmdBuff) override;
+
 	bool isTessellationPipeline() override;
 
+	bool hasRemappedAttachmentLocations() override;
+
 protected:
 	MVKCommandTypePool<MVKCommand>* getTypePool(MVKCommandPool* cmdPool) override;
 
@@ -140,61 +150,33 @@ class MVKCmdBindComputePipeline : public MVKCmdBindPipeline {
 public:
 	void encode(MVKCommandEncoder* cmdEncoder) override;
 
-protected:
-	MVKCommandTypePool<MVKCommand>* getTypePool(MVKCommandPool* cmdPool) override;
-
-};
-
-
-#pragma mark -
-#pragma mark MVKCmdBindDescriptorSetsStatic
-
-/**
- * Vulkan command to bind descriptor sets without dynamic offsets.
- * Template class to balance vector pre-allocations between very common low counts and fewer larger counts.
- */
-template <size_t N>
-class MVKCmdBindDescriptorSetsStatic : public MVKCommand {
-
-public:
-	VkResult setContent(MVKCommandBuffer* cmdBuff,
-						VkPipelineBindPoint pipelineBindPoint,
-						VkPipelineLayout layout,
-						uint32_t firstSet,
-						uint32_t setCount,
-						const VkDescriptorSet* pDescriptorSets);
-
-	void encode(MVKCommandEncoder* cmdEncoder) override;
-
-	~MVKCmdBindDescriptorSetsStatic() override;
+	MVKCommandCompaction getCompaction(MVKCommandBuffer* cmdBuff) override;
 
 protected:
 	MVKCommandTypePool<MVKCommand>* getTypePool(MVKCommandPool* cmdPool) override;
-	void encode(MVKCommandEncoder* cmdEncoder, MVKArrayRef<uint32_t> dynamicOffsets);
 
-	MVKSmallVector<MVKDescriptorSet*, N> _descriptorSets;
-	MVKPipelineLayout* _pipelineLayout = nullptr;
-	VkPipelineBindPoint _pipelineBindPoint;
-	uint32_t _firstSet;
 };
 
-// Concrete template class implementations.
-typedef MVKCmdBindDescriptorSetsStatic<1> MVKCmdBindDescriptorSetsStatic1;
-typedef MVKCmdBindDescriptorSetsStatic<4> MVKCmdBindDescriptorSetsStatic4;
-typedef MVKCmdBindDescriptorSetsStatic<8> MVKCmdBindDescriptorSetsStaticMulti;
-
 
 #pragma mark -
-#pragma mark MVKCmdBindDescriptorSetsDynamic
+#pragma mark MVKCmdBindDescriptorSets
 
 /**
- * Vulkan command to bind descriptor sets with dynamic offsets.
- * Template class to balance vector pre-allocations between very common low counts and fewer larger counts.
+ * Vulkan command to bind descriptor sets, with or without dynamic offsets.
+ * The descriptor sets and dynamic offsets are stored inline after the command.
  */
-template <size_t N>
-class MVKCmdBindDescriptorSetsDynamic : public MVKCmdBindDescriptorSetsStatic<N> {
+class MVKCmdBindDescriptorSets : public MVKInlineCommand {
 
 public:
+	static MVKCmdBindDescriptorSets* newCommand(MVKCommandBuffer* cmdBuff,
+												VkPipelineBindPoint pipelineBindPoint,
+												VkPipelineLayout layout,
+												uint32_t firstSet,
+												uint32_t setCount,
+												const VkDescriptorSet* pDescriptorSets,
+												uint32_t dynamicOffsetCount,
+												const uint32_t* pDynamicOffsets);
+
 	VkResult setContent(MVKCommandBuffer* cmdBuff,
 						VkPipelineBindPoint pipelineBindPoint,
 						VkPipelineLayout layout,
@@ -206,16 +188,18 @@ public:
 
 	void encode(MVKCommandEncoder* cmdEncoder) override;
 
+	~MVKCmdBindDescriptorSets() override;
+
 protected:
-	MVKCommandTypePool<MVKCommand>* getTypePool(MVKCommandPool* cmdPool) override;
+	friend class MVKInlineObjectConstructor<MVKCmdBindDescriptorSets>;
 
-	MVKSmallVector<uint32_t, N> _dynamicOffsets;
+	MVKInlineArray<MVKDescriptorSet*> _descriptorSets;
+	MVKInlineArray<uint32_t> _dynamicOffsets;
+	MVKPipelineLayout* _pipelineLayout = nullptr;
+	VkPipelineBindPoint _pipelineBindPoint;
+	uint32_t _firstSet;
 };
 
-// Concrete template class implementations.
-typedef MVKCmdBindDescriptorSetsDynamic<4> MVKCmdBindDescriptorSetsDynamic4;
-typedef MVKCmdBindDescriptorSetsDynamic<8> MVKCmdBindDescriptorSetsDynamicMulti;
-
 
 #pragma mark -
 #pragma mark MVKCmdPushConstants
@@ -22,6 +22,7 @@
 #include "MVKImage.h"
 #include "MVKBuffer.h"
 #include "MVKPipeline.h"
+#include "MVKInlineObjectConstructor.h"
 #include "MVKFoundation.h"
 #include "mvk_datatypes.hpp"
 
@@ -253,10 +254,18 @@ void MVKCmdBindGraphicsPipeline::encode(MVKCommandEncoder* cmdEncoder) {
 	cmdEncoder->bindPipeline(VK_PIPELINE_BIND_POINT_GRAPHICS, _pipeline);
 }
 
+MVKCommandCompaction MVKCmdBindGraphicsPipeline::getCompaction(MVKCommandBuffer* cmdBuff) {
+	return cmdBuff->compactBindPipeline(this, VK_PIPELINE_BIND_POINT_GRAPHICS);
+}
+
 bool MVKCmdBindGraphicsPipeline::isTessellationPipeline() {
 	return ((MVKGraphicsPipeline*)_pipeline)->isTessellationPipeline();
 }
 
+bool MVKCmdBindGraphicsPipeline::hasRemappedAttachmentLocations() {
+	return ((MVKGraphicsPipeline*)_pipeline)->hasRemappedAttachmentLocations();
+}
+
 
 #pragma mark -
 #pragma mark MVKCmdBindComputePipeline
@@ -265,88 +274,65 @@ void MVKCmdBindComputePipeline::encode(MVKCommandEncoder* cmdEncoder) {
 	cmdEncoder->bindPipeline(VK_PIPELINE_BIND_POINT_COMPUTE, _pipeline);
 }
 
+MVKCommandCompaction MVKCmdBindComputePipeline::getCompaction(MVKCommandBuffer* cmdBuff) {
+	return cmdBuff->compactBindPipeline(this, VK_PIPELINE_BIND_POINT_COMPUTE);
+}
 
-#pragma mark -
-#pragma mark MVKCmdBindDescriptorSetsStatic
 
-template <size_t N>
-VkResult MVKCmdBindDescriptorSetsStatic<N>::setContent(MVKCommandBuffer* cmdBuff,
-													   VkPipelineBindPoint pipelineBindPoint,
-													   VkPipelineLayout layout,
-													   uint32_t firstSet,
-													   uint32_t setCount,
-													   const VkDescriptorSet* pDescriptorSets) {
-	if (_pipelineLayout) { _pipelineLayout->release(); }
+#pragma mark -
+#pragma mark MVKCmdBindDescriptorSets
+
+MVKCmdBindDescriptorSets* MVKCmdBindDescriptorSets::newCommand(MVKCommandBuffer* cmdBuff,
+															   VkPipelineBindPoint pipelineBindPoint,
+															   VkPipelineLayout layout,
+															   uint32_t firstSet,
+															   uint32_t setCount,
+															   const VkDescriptorSet* pDescriptorSets,
+															   uint32_t dynamicOffsetCount,
+															   const uint32_t* pDynamicOffsets) {
+	using Constructor = MVKInlineObjectConstructor<MVKCmdBindDescriptorSets>;
+	return Constructor::CreateWithAllocator(
+		[cmdBuff](size_t byteCount) { return cmdBuff->allocateCommandStorage(byteCount); },
+		std::tuple {
+			Constructor::Uninit(&MVKCmdBindDescriptorSets::_descriptorSets, setCount),
+			Constructor::Uninit(&MVKCmdBindDescriptorSets::_dynamicOffsets, dynamicOffsetCount),
+		}
+	);
+}
 
+VkResult MVKCmdBindDescriptorSets::setContent(MVKCommandBuffer* cmdBuff,
+											  VkPipelineBindPoint pipelineBindPoint,
+											  VkPipelineLayout layout,
+											  uint32_t firstSet,
+											  uint32_t setCount,
+											  const VkDescriptorSet* pDescriptorSets,
+											  uint32_t dynamicOffsetCount,
+											  const uint32_t* pDynamicOffsets) {
 	_pipelineBindPoint = pipelineBindPoint;
 	_pipelineLayout = (MVKPipelineLayout*)layout;
 	_firstSet = firstSet;
 
 	_pipelineLayout->retain();
 
-	// Add the descriptor sets
-	_descriptorSets.clear();	// Clear for reuse
-	_descriptorSets.reserve(setCount);
 	for (uint32_t dsIdx = 0; dsIdx < setCount; dsIdx++) {
-		_descriptorSets.push_back((MVKDescriptorSet*)pDescriptorSets[dsIdx]);
+		_descriptorSets[dsIdx] = (MVKDescriptorSet*)pDescriptorSets[dsIdx];
 	}
-
-	return VK_SUCCESS;
-}
-
-template <size_t N>
-void MVKCmdBindDescriptorSetsStatic<N>::encode(MVKCommandEncoder* cmdEncoder) {
-	encode(cmdEncoder, MVKArrayRef<uint32_t>());
-}
-
-template <size_t N>
-void MVKCmdBindDescriptorSetsStatic<N>::encode(MVKCommandEncoder* cmdEncoder, MVKArrayRef<uint32_t> dynamicOffsets) {
-	cmdEncoder->getState().bindDescriptorSets(_pipelineBindPoint, _pipelineLayout, _firstSet, static_cast<uint32_t>(_descriptorSets.size()), _descriptorSets.data(), static_cast<uint32_t>(dynamicOffsets.size()), dynamicOffsets.data());
-}
-
-template <size_t N>
-MVKCmdBindDescriptorSetsStatic<N>::~MVKCmdBindDescriptorSetsStatic() {
-	if (_pipelineLayout) { _pipelineLayout->release(); }
-}
-
-template class MVKCmdBindDescriptorSetsStatic<1>;
-template class MVKCmdBindDescriptorSetsStatic<4>;
-template class MVKCmdBindDescriptorSetsStatic<8>;
-
-
-#pragma mark -
-#pragma mark MVKCmdBindDescriptorSetsDynamic
-
-template <size_t N>
-VkResult MVKCmdBindDescriptorSetsDynamic<N>::setContent(MVKCommandBuffer* cmdBuff,
-														VkPipelineBindPoint pipelineBindPoint,
-														VkPipelineLayout layout,
-														uint32_t firstSet,
-														uint32_t setCount,
-														const VkDescriptorSet* pDescriptorSets,
-														uint32_t dynamicOffsetCount,
-														const uint32_t* pDynamicOffsets) {
-
-	MVKCmdBindDescriptorSetsStatic<N>::setContent(cmdBuff, pipelineBindPoint, layout,
-												  firstSet, setCount, pDescriptorSets);
-
-	// Add the dynamic offsets
-	_dynamicOffsets.clear();	// Clear for reuse
-	_dynamicOffsets.reserve(dynamicOffsetCount);
 	for (uint32_t doIdx = 0; doIdx < dynamicOffsetCount; doIdx++) {
-		_dynamicOffsets.push_back(pDynamicOffsets[doIdx]);
+		_dynamicOffsets[doIdx] = pDynamicOffsets[doIdx];
 	}
 
 	return VK_SUCCESS;
 }
 
-template <size_t N>
-void MVKCmdBindDescriptorSetsDynamic<N>::encode(MVKCommandEncoder* cmdEncoder) {
-	MVKCmdBindDescriptorSetsStatic<N>::encode(cmdEncoder, _dynamicOffsets.contents());
+void MVKCmdBindDescriptorSets::encode(MVKCommandEncoder* cmdEncoder) {
+	cmdEncoder->getState().bindDescriptorSets(_pipelineBindPoint, _pipelineLayout, _firstSet,
+											  static_cast<uint32_t>(_descriptorSets.size()), _descriptorSets.data(),
+											  static_cast<uint32_t>(_dynamicOffsets.size()), _dynamicOffsets.data());
 }
 
-template class MVKCmdBindDescriptorSetsDynamic<4>;
-template class MVKCmdBindDescriptorSetsDynamic<8>;
+MVKCmdBindDescriptorSets::~MVKCmdBindDescriptorSets() {
+	if (_pipelineLayout) { _pipelineLayout->release(); }
+}
 
 
 #pragma mark -
@@ -370,7 +356,7 @@ VkResult MVKCmdPushConstants<N>::setContent(MVKCommandBuffer* cmdBuff,
 
 template <size_t N>
 void MVKCmdPushConstants<N>::encode(MVKCommandEncoder* cmdEncoder) {
-	cmdEncoder->getState().pushConstants(_offset, static_cast<uint32_t>(_pushConstants.byteSize()), _pushConstants.data());
+	cmdEncoder->getState().pushConstants(_stageFlags, _offset, static_cast<uint32_t>(_pushConstants.byteSize()), _pushConstants.data());
 }
 
 template class MVKCmdPushConstants<64>;
@@ -132,8 +132,11 @@ public:
 
     void encode(MVKCommandEncoder* cmdEncoder) override;
 
+	MVKCommandCompaction getCompaction(MVKCommandBuffer* cmdBuff) override;
+
 protected:
 	MVKCommandTypePool<MVKCommand>* getTypePool(MVKCommandPool* cmdPool) override;
+	bool merge(MVKCmdCopyQueryPoolResults* nextCmd);
 
     MVKBuffer* _destBuffer;
     VkDeviceSize _destOffset;
@@ -152,3 +152,31 @@ void MVKCmdCopyQueryPoolResults::encode(MVKCommandEncoder* cmdEncoder) {
     }
 }
 
+// If this command immediately follows a copy of the preceding queries of the same pool, to the preceding
+// results in the same buffer, with the same layout, extend that command to cover this copy, and drop this
+// command, so the copies are encoded together, using a single copy or compute dispatch.
+MVKCommandCompaction MVKCmdCopyQueryPoolResults::getCompaction(MVKCommandBuffer* cmdBuff) {
+	auto* prevCmd = cmdBuff->getMergeableCopyQueryPoolResultsCommand();
+	if (prevCmd && prevCmd->merge(this)) {
+		cmdBuff->recordCoalescedCopyRegions(1);
+		return MVKCommandCompactionDrop;
+	}
+	cmdBuff->recordCopyQueryPoolResults(this);
+	return MVKCommandCompactionNone;
+}
+
+// A stride that is smaller than the result of each query, such as the zero stride allowed when copying a
+// single query, would make the results of the merged copy overlap, so such copies are not merged.
+bool MVKCmdCopyQueryPoolResults::merge(MVKCmdCopyQueryPoolResults* nextCmd) {
+	if (_destStride < _queryPool->getResultSize(_flags) ||
+		nextCmd->_queryPool != _queryPool ||
+		nextCmd->_destBuffer != _destBuffer ||
+		nextCmd->_destStride != _destStride ||
+		nextCmd->_flags != _flags ||
+		nextCmd->_query != _query + _queryCount ||
+		nextCmd->_destOffset != _destOffset + (_destStride * _queryCount)) { return false; }
+
+	_queryCount += nextCmd->_queryCount;
+	return true;
+}
+
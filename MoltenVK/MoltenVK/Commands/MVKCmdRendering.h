@@ -139,6 +139,16 @@ protected:
 #pragma mark -
 #pragma mark MVKCmdBeginRendering
 
+/**
+ * The transient renderpass and framebuffer objects of a dynamic rendering command in a reusable
+ * primary command buffer, created when the command buffer is ended, and owned by that command buffer.
+ */
+typedef struct MVKCachedRenderingObjects {
+	const VkRenderingInfo* pRenderingInfo = nullptr;
+	MVKRenderPass* renderPass = nullptr;
+	MVKFramebuffer* framebuffer = nullptr;
+} MVKCachedRenderingObjects;
+
 /**
  * Vulkan command to begin rendering.
  * Template class to balance vector pre-allocations between very common low counts and fewer larger counts.
@@ -157,6 +167,7 @@ protected:
 	MVKCommandTypePool<MVKCommand>* getTypePool(MVKCommandPool* cmdPool) override;
 
 	VkRenderingInfo _renderingInfo;
+	MVKCachedRenderingObjects _cachedRenderingObjects;
 	MVKSmallVector<VkRenderingAttachmentInfo, N> _colorAttachments;
 	VkRenderingAttachmentInfo _depthAttachment;
 	VkRenderingAttachmentInfo _stencilAttachment;
@@ -274,6 +285,8 @@ public:
 
 	void encode(MVKCommandEncoder* cmdEncoder) override;
 
+	MVKCommandCompaction getCompaction(MVKCommandBuffer* cmdBuff) override;
+
 protected:
 	MVKCommandTypePool<MVKCommand>* getTypePool(MVKCommandPool* cmdPool) override;
 
@@ -304,6 +317,8 @@ public:
 
 	void encode(MVKCommandEncoder* cmdEncoder) override;
 
+	MVKCommandCompaction getCompaction(MVKCommandBuffer* cmdBuff) override;
+
 protected:
 	MVKCommandTypePool<MVKCommand>* getTypePool(MVKCommandPool* cmdPool) override;
 
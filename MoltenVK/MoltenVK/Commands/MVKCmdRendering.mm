@@ -38,6 +38,7 @@ VkResult MVKCmdBeginRenderPassBase::setContent(MVKCommandBuffer* cmdBuff,
 	_renderArea = pRenderPassBegin->renderArea;
 
 	cmdBuff->_currentSubpassInfo.beginRenderpass(_renderPass);
+	cmdBuff->recordGraphicsPipelineStateChange();
 
 	return VK_SUCCESS;
 }
@@ -96,6 +97,7 @@ VkResult MVKCmdNextSubpass::setContent(MVKCommandBuffer* cmdBuff,
 	_contents = contents;
 
 	cmdBuff->_currentSubpassInfo.nextSubpass();
+	cmdBuff->recordGraphicsPipelineStateChange();
 
 	return VK_SUCCESS;
 }
@@ -151,13 +153,16 @@ VkResult MVKCmdBeginRendering<N>::setContent(MVKCommandBuffer* cmdBuff,
 	}
 
 	cmdBuff->_currentSubpassInfo.beginRendering(pRenderingInfo->viewMask);
+	cmdBuff->recordGraphicsPipelineStateChange();
+	_cachedRenderingObjects = {};
+	cmdBuff->recordBeginRendering(&_cachedRenderingObjects, &_renderingInfo);
 
 	return VK_SUCCESS;
 }
 
 template <size_t N>
 void MVKCmdBeginRendering<N>::encode(MVKCommandEncoder* cmdEncoder) {
-	cmdEncoder->beginRendering(this, &_renderingInfo);
+	cmdEncoder->beginRendering(this, &_renderingInfo, _cachedRenderingObjects);
 }
 
 template class MVKCmdBeginRendering<1>;
@@ -182,6 +187,8 @@ VkResult MVKCmdSetRenderingAttachmentLocations::setContent(MVKCommandBuffer* cmd
 	mvkPopulateFromOrFillAscending(_colorAttachmentLocations,
 								   pLocationInfo->pColorAttachmentLocations,
 								   pLocationInfo->colorAttachmentCount);
+	cmdBuff->recordGraphicsPipelineStateChange();
+	cmdBuff->recordRenderPassModification();
 	return VK_SUCCESS;
 }
 
@@ -205,6 +212,8 @@ VkResult MVKCmdSetRenderingInputAttachmentIndices::setContent(MVKCommandBuffer*
 	_hasStencilInputAttachmentIndex = pInputAttachmentIndexInfo->pStencilInputAttachmentIndex;
 	_stencilInputAttachmentIndex = _hasStencilInputAttachmentIndex ? *pInputAttachmentIndexInfo->pStencilInputAttachmentIndex : 0;
 
+	cmdBuff->recordRenderPassModification();
+
 	return VK_SUCCESS;
 }
 
@@ -288,6 +297,11 @@ void MVKCmdSetViewport<N>::encode(MVKCommandEncoder* cmdEncoder) {
 		state._viewports[i] = _viewports[i - _firstViewport];
 }
 
+template <size_t N>
+MVKCommandCompaction MVKCmdSetViewport<N>::getCompaction(MVKCommandBuffer* cmdBuff) {
+	return cmdBuff->compactViewports(this, _firstViewport, _viewports.contents());
+}
+
 template class MVKCmdSetViewport<1>;
 template class MVKCmdSetViewport<kMVKMaxViewportScissorCount>;
 
@@ -319,6 +333,11 @@ void MVKCmdSetScissor<N>::encode(MVKCommandEncoder* cmdEncoder) {
 		state._scissors[i] = _scissors[i - _firstScissor];
 }
 
+template <size_t N>
+MVKCommandCompaction MVKCmdSetScissor<N>::getCompaction(MVKCommandBuffer* cmdBuff) {
+	return cmdBuff->compactScissors(this, _firstScissor, _scissors.contents());
+}
+
 template class MVKCmdSetScissor<1>;
 template class MVKCmdSetScissor<kMVKMaxViewportScissorCount>;
 
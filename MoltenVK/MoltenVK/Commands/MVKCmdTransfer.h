@@ -30,6 +30,163 @@ class MVKImage;
 class MVKBuffer;
 
 
+#pragma mark -
+#pragma mark Copy region coalescing
+
+/**
+ * Merges each region in the vector into the region before it, where the mergeRegions() function
+ * can combine the two, and compacts the vector. The mergeRegions() function has the signature
+ * bool(R& region, const R& nextRegion), and updates region to cover both regions if it returns true.
+ *
+ * Returns the number of regions removed from the vector.
+ */
+template <typename V, typename F>
+static inline uint32_t mvkCoalesceAdjacentRegions(V& regions, F mergeRegions) {
+	size_t rgnCnt = regions.size();
+	if (rgnCnt < 2) { return 0; }
+
+	size_t lastIdx = 0;
+	for (size_t rgnIdx = 1; rgnIdx < rgnCnt; rgnIdx++) {
+		if ( !mergeRegions(regions[lastIdx], regions[rgnIdx]) ) {
+			if (++lastIdx != rgnIdx) { regions[lastIdx] = regions[rgnIdx]; }
+		}
+	}
+	size_t keepCnt = lastIdx + 1;
+	regions.resize(keepCnt);
+	return uint32_t(rgnCnt - keepCnt);
+}
+
+/**
+ * Sorts the buffer copy regions by source offset, and merges regions whose source and destination
+ * ranges both directly follow those of the previous region. Buffer copy regions cannot overlap,
+ * so reordering them does not change the result of the copy.
+ *
+ * Returns the number of regions removed from the vector.
+ */
+template <typename V>
+static inline uint32_t mvkCoalesceBufferCopyRegions(V& regions) {
+	if (regions.size() < 2) { return 0; }
+
+	std::sort(regions.data(), regions.data() + regions.size(), [](const VkBufferCopy2& a, const VkBufferCopy2& b) {
+		return a.srcOffset != b.srcOffset ? a.srcOffset < b.srcOffset : a.dstOffset < b.dstOffset;
+	});
+	return mvkCoalesceAdjacentRegions(regions, [](VkBufferCopy2& rgn, const VkBufferCopy2& nextRgn) {
+		if (nextRgn.srcOffset != rgn.srcOffset + rgn.size || nextRgn.dstOffset != rgn.dstOffset + rgn.size) { return false; }
+		rgn.size += nextRgn.size;
+		return true;
+	});
+}
+
+/** Returns whether the two image subresource layers are identical. */
+static inline bool mvkImageSubresourceLayersAreEqual(const VkImageSubresourceLayers& a, const VkImageSubresourceLayers& b) {
+	return (a.aspectMask == b.aspectMask &&
+			a.mipLevel == b.mipLevel &&
+			a.baseArrayLayer == b.baseArrayLayer &&
+			a.layerCount == b.layerCount);
+}
+
+/**
+ * Returns whether the subresource b directly follows the array layers of subresource a,
+ * within the same aspect and mip level.
+ */
+static inline bool mvkImageSubresourceLayersAreConsecutive(const VkImageSubresourceLayers& a, const VkImageSubresourceLayers& b) {
+	return (a.aspectMask == b.aspectMask &&
+			a.mipLevel == b.mipLevel &&
+			a.layerCount != VK_REMAINING_ARRAY_LAYERS &&
+			b.layerCount != VK_REMAINING_ARRAY_LAYERS &&
+			b.baseArrayLayer == a.baseArrayLayer + a.layerCount);
+}
+
+/**
+ * Merges each image copy region into the region recorded before it, where both regions copy
+ * between the same subresources, and the source and destination rectangles of the region abut
+ * those of the previous region along the same edge, or where both regions copy the same
+ * rectangles between consecutive array layers.
+ *
+ * The canCoalesce() function has the signature bool(const VkImageCopy2& region), and returns
+ * whether the region can be merged. Merged regions always copy between the same image aspects.
+ *
+ * Returns the number of regions removed from the vector.
+ */
+template <typename V, typename F>
+static inline uint32_t mvkCoalesceImageCopyRegions(V& regions, F canCoalesce) {
+	return mvkCoalesceAdjacentRegions(regions, [&](VkImageCopy2& rgn, const VkImageCopy2& nextRgn) {
+		if ( !canCoalesce(rgn) ) { return false; }
+
+		bool isSameSrcSub = mvkImageSubresourceLayersAreEqual(rgn.srcSubresource, nextRgn.srcSubresource);
+		bool isSameDstSub = mvkImageSubresourceLayersAreEqual(rgn.dstSubresource, nextRgn.dstSubresource);
+		bool isSameZ = (rgn.srcOffset.z == nextRgn.srcOffset.z && rgn.dstOffset.z == nextRgn.dstOffset.z &&
+						rgn.extent.depth == nextRgn.extent.depth);
+
+		if (isSameSrcSub && isSameDstSub && isSameZ) {
+			// Horizontally abutting rectangles of the same height
+			if (rgn.extent.height == nextRgn.extent.height &&
+				rgn.srcOffset.y == nextRgn.srcOffset.y && rgn.dstOffset.y == nextRgn.dstOffset.y &&
+				nextRgn.srcOffset.x == rgn.srcOffset.x + int32_t(rgn.extent.width) &&
+				nextRgn.dstOffset.x == rgn.dstOffset.x + int32_t(rgn.extent.width)) {
+				rgn.extent.width += nextRgn.extent.width;
+				return true;
+			}
+			// Vertically abutting rectangles of the same width
+			if (rgn.extent.width == nextRgn.extent.width &&
+				rgn.srcOffset.x == nextRgn.srcOffset.x && rgn.dstOffset.x == nextRgn.dstOffset.x &&
+				nextRgn.srcOffset.y == rgn.srcOffset.y + int32_t(rgn.extent.height) &&
+				nextRgn.dstOffset.y == rgn.dstOffset.y + int32_t(rgn.extent.height)) {
+				rgn.extent.height += nextRgn.extent.height;
+				return true;
+			}
+			return false;
+		}
+
+		// Identical rectangles in consecutive array layers
+		if (mvkImageSubresourceLayersAreConsecutive(rgn.srcSubresource, nextRgn.srcSubresource) &&
+			mvkImageSubresourceLayersAreConsecutive(rgn.dstSubresource, nextRgn.dstSubresource) &&
+			rgn.srcSubresource.layerCount == rgn.dstSubresource.layerCount &&
+			nextRgn.srcSubresource.layerCount == nextRgn.dstSubresource.layerCount &&
+			mvkVkOffset3DsAreEqual(rgn.srcOffset, nextRgn.srcOffset) &&
+			mvkVkOffset3DsAreEqual(rgn.dstOffset, nextRgn.dstOffset) &&
+			mvkVkExtent3DsAreEqual(rgn.extent, nextRgn.extent)) {
+			rgn.srcSubresource.layerCount += nextRgn.srcSubresource.layerCount;
+			rgn.dstSubresource.layerCount += nextRgn.dstSubresource.layerCount;
+			return true;
+		}
+		return false;
+	});
+}
+
+/**
+ * Merges each buffer-image copy region into the region recorded before it, where both regions
+ * copy a single layer and depth slice of the same subresource, the image rectangle of the region
+ * lies directly below that of the previous region with the same horizontal extent, and the buffer
+ * rows of the region directly follow those of the previous region.
+ *
+ * The getBytesPerRow() function has the signature size_t(const VkBufferImageCopy2& region), and
+ * returns the number of bytes in each buffer row of the region, or zero if the region cannot be merged.
+ *
+ * Returns the number of regions removed from the vector.
+ */
+template <typename V, typename F>
+static inline uint32_t mvkCoalesceBufferImageCopyRegions(V& regions, F getBytesPerRow) {
+	return mvkCoalesceAdjacentRegions(regions, [&](VkBufferImageCopy2& rgn, const VkBufferImageCopy2& nextRgn) {
+		if ( !(mvkImageSubresourceLayersAreEqual(rgn.imageSubresource, nextRgn.imageSubresource) &&
+			   rgn.imageSubresource.layerCount == 1 &&
+			   rgn.imageExtent.depth == 1 && nextRgn.imageExtent.depth == 1 &&
+			   rgn.imageOffset.z == nextRgn.imageOffset.z &&
+			   rgn.imageOffset.x == nextRgn.imageOffset.x &&
+			   rgn.imageExtent.width == nextRgn.imageExtent.width &&
+			   rgn.bufferRowLength == nextRgn.bufferRowLength &&
+			   nextRgn.imageOffset.y == rgn.imageOffset.y + int32_t(rgn.imageExtent.height)) ) { return false; }
+
+		size_t bytesPerRow = getBytesPerRow(rgn);
+		if ( !bytesPerRow || nextRgn.bufferOffset != rgn.bufferOffset + bytesPerRow * rgn.imageExtent.height) { return false; }
+
+		rgn.imageExtent.height += nextRgn.imageExtent.height;
+		rgn.bufferImageHeight = 0;
+		return true;
+	});
+}
+
+
 #pragma mark -
 #pragma mark MVKCmdCopyImage
 
@@ -57,6 +214,7 @@ public:
 
 protected:
 	MVKCommandTypePool<MVKCommand>* getTypePool(MVKCommandPool* cmdPool) override;
+	void coalesceRegions(MVKCommandBuffer* cmdBuff);
     VkResult validate(MVKCommandBuffer* cmdBuff, const VkImageCopy2* region);
 
 	MVKSmallVector<VkImageCopy2, N> _vkImageCopies;
@@ -174,6 +332,57 @@ typedef MVKCmdResolveImage<4> MVKCmdResolveImageMulti;
 #pragma mark -
 #pragma mark MVKCmdCopyBuffer
 
+/** A contiguous span of bytes to be copied between two buffers. */
+typedef struct MVKBufferCopySpan {
+	VkDeviceSize srcOffset = 0;
+	VkDeviceSize dstOffset = 0;
+	VkDeviceSize size = 0;
+} MVKBufferCopySpan;
+
+/**
+ * Describes how a single buffer copy region is split between the blit encoder, which requires
+ * offsets and sizes aligned to the Metal copy alignment, and a compute kernel that handles the
+ * unaligned head and tail fragments. Any of the spans may be empty.
+ */
+typedef struct MVKBufferCopyPlan {
+	MVKBufferCopySpan head;		/**< Leading unaligned bytes, copied by compute. */
+	MVKBufferCopySpan body;		/**< Aligned middle, copied by blit. */
+	MVKBufferCopySpan tail;		/**< Trailing unaligned bytes, copied by compute. */
+} MVKBufferCopyPlan;
+
+/**
+ * Splits the buffer copy region into an aligned body that can be copied by a blit encoder,
+ * and unaligned head and tail fragments that must be copied by compute.
+ *
+ * If the source and destination offsets are misaligned relative to each other, no aligned
+ * body exists, and the entire region is returned in the head.
+ */
+static inline MVKBufferCopyPlan mvkPlanBufferCopy(VkDeviceSize srcOffset,
+												  VkDeviceSize dstOffset,
+												  VkDeviceSize size,
+												  VkDeviceSize alignment) {
+	MVKBufferCopyPlan plan;
+	if (alignment <= 1) {
+		plan.body = { srcOffset, dstOffset, size };
+		return plan;
+	}
+
+	VkDeviceSize srcMisalign = srcOffset % alignment;
+	if (srcMisalign != dstOffset % alignment) {
+		plan.head = { srcOffset, dstOffset, size };
+		return plan;
+	}
+
+	VkDeviceSize headSize = srcMisalign ? std::min(alignment - srcMisalign, size) : 0;
+	VkDeviceSize bodySize = ((size - headSize) / alignment) * alignment;
+	VkDeviceSize tailSize = size - headSize - bodySize;
+
+	plan.head = { srcOffset, dstOffset, headSize };
+	plan.body = { srcOffset + headSize, dstOffset + headSize, bodySize };
+	plan.tail = { srcOffset + headSize + bodySize, dstOffset + headSize + bodySize, tailSize };
+	return plan;
+}
+
 /**
  * Vulkan command to copy buffer regions.
  * Template class to balance vector pre-allocations between very common low counts and fewer larger counts.
@@ -192,8 +401,14 @@ public:
 
 	void encode(MVKCommandEncoder* cmdEncoder) override;
 
+	MVKCommandCompaction getCompaction(MVKCommandBuffer* cmdBuff) override;
+
 protected:
 	MVKCommandTypePool<MVKCommand>* getTypePool(MVKCommandPool* cmdPool) override;
+	void encodeComputeCopy(MVKCommandEncoder* cmdEncoder,
+						   id<MTLComputeCommandEncoder> mtlComputeEnc,
+						   id<MTLComputePipelineState> cps,
+						   const MVKBufferCopySpan& span);
 
 	MVKSmallVector<VkBufferCopy2, N> _bufferCopyRegions;
 	MVKBuffer* _srcBuffer;
@@ -233,6 +448,7 @@ public:
 protected:
 	MVKCommandTypePool<MVKCommand>* getTypePool(MVKCommandPool* cmdPool) override;
 	bool isArrayTexture();
+	void coalesceRegions(MVKCommandBuffer* cmdBuff);
     VkResult validate(MVKCommandBuffer* cmdBuff);
 
 	MVKSmallVector<VkBufferImageCopy2, N> _bufferImageCopyRegions;
@@ -439,10 +655,14 @@ public:
 
     void encode(MVKCommandEncoder* cmdEncoder) override;
 
+	MVKCommandCompaction getCompaction(MVKCommandBuffer* cmdBuff) override;
+
 protected:
 	MVKCommandTypePool<MVKCommand>* getTypePool(MVKCommandPool* cmdPool) override;
+	bool merge(MVKCmdUpdateBuffer* nextCmd);
 
-	MVKSmallVector<uint8_t> _srcDataCache;
+	id<MTLBuffer> _srcMTLBuffer;
+	NSUInteger _srcMTLBufferOffset;
 	MVKBuffer* _dstBuffer;
     VkDeviceSize _dstOffset;
     VkDeviceSize _dataSize;
@@ -74,6 +74,7 @@ VkResult MVKCmdCopyImage<N>::setContent(MVKCommandBuffer* cmdBuff,
         
         _vkImageCopies.emplace_back(std::move(vkIR2));
 	}
+	coalesceRegions(cmdBuff);
     
 	return VK_SUCCESS;
 }
@@ -97,10 +98,25 @@ VkResult MVKCmdCopyImage<N>::setContent(MVKCommandBuffer* cmdBuff,
         
         _vkImageCopies.push_back(vkIR);
     }
+	coalesceRegions(cmdBuff);
     
     return VK_SUCCESS;
 }
 
+// Merge regions that copy abutting rectangles or consecutive array layers. The extent of each region is in
+// source texels, and is scaled to destination texels when the source and destination block extents differ,
+// so destination adjacency can only be determined from the extent when the block extents are the same.
+template <size_t N>
+void MVKCmdCopyImage<N>::coalesceRegions(MVKCommandBuffer* cmdBuff) {
+	MVKPixelFormats* pixFmts = cmdBuff->getPixelFormats();
+	uint32_t rgnCnt = mvkCoalesceImageCopyRegions(_vkImageCopies, [&](const VkImageCopy2& cpyRgn) {
+		MTLPixelFormat srcMTLPixFmt = _srcImage->getMTLPixelFormat(MVKImage::getPlaneFromVkImageAspectFlags(cpyRgn.srcSubresource.aspectMask));
+		MTLPixelFormat dstMTLPixFmt = _dstImage->getMTLPixelFormat(MVKImage::getPlaneFromVkImageAspectFlags(cpyRgn.dstSubresource.aspectMask));
+		return mvkVkExtent2DsAreEqual(pixFmts->getBlockTexelSize(srcMTLPixFmt), pixFmts->getBlockTexelSize(dstMTLPixFmt));
+	});
+	cmdBuff->recordCoalescedCopyRegions(rgnCnt);
+}
+
 static inline MTLPixelFormat getDepthStencilAspectFormat(const MTLPixelFormat format, const VkImageAspectFlags aspectMask) {
     if (format == MTLPixelFormatDepth32Float_Stencil8) {
         if (aspectMask & VK_IMAGE_ASPECT_DEPTH_BIT) return MTLPixelFormatDepth32Float;
@@ -968,9 +984,9 @@ template class MVKCmdResolveImage<4>;
 
 // Matches shader struct.
 typedef struct {
-	uint32_t srcOffset;
-	uint32_t dstOffset;
-	uint32_t size;
+	uint64_t srcOffset;
+	uint64_t dstOffset;
+	uint64_t size;
 } MVKCmdCopyBufferInfo;
 
 template <size_t N>
@@ -993,6 +1009,7 @@ VkResult MVKCmdCopyBuffer<N>::setContent(MVKCommandBuffer* cmdBuff,
         };
 		_bufferCopyRegions.emplace_back(std::move(region2));
 	}
+	cmdBuff->recordCoalescedCopyRegions(mvkCoalesceBufferCopyRegions(_bufferCopyRegions));
 
 	return VK_SUCCESS;
 }
@@ -1009,10 +1026,27 @@ VkResult MVKCmdCopyBuffer<N>::setContent(MVKCommandBuffer* cmdBuff,
     for (uint32_t i = 0; i < pCopyBufferInfo->regionCount; i++) {
         _bufferCopyRegions.push_back(pCopyBufferInfo->pRegions[i]);
     }
+	cmdBuff->recordCoalescedCopyRegions(mvkCoalesceBufferCopyRegions(_bufferCopyRegions));
 
     return VK_SUCCESS;
 }
 
+// If this command immediately follows a copy between the same buffers, absorb the regions of that
+// command, and replace it. Record the resulting regions for merging with any following copy command.
+template <size_t N>
+MVKCommandCompaction MVKCmdCopyBuffer<N>::getCompaction(MVKCommandBuffer* cmdBuff) {
+	auto compaction = MVKCommandCompactionNone;
+	auto prevRegions = cmdBuff->getMergeableCopyBufferRegions(_srcBuffer, _dstBuffer);
+	if (prevRegions.size()) {
+		_bufferCopyRegions.reserve(_bufferCopyRegions.size() + prevRegions.size());
+		for (auto& rgn : prevRegions) { _bufferCopyRegions.push_back(rgn); }
+		cmdBuff->recordCoalescedCopyRegions(mvkCoalesceBufferCopyRegions(_bufferCopyRegions));
+		compaction = MVKCommandCompactionReplaceLast;
+	}
+	cmdBuff->recordCopyBuffer(this, _srcBuffer, _dstBuffer, _bufferCopyRegions.contents());
+	return compaction;
+}
+
 template <size_t N>
 void MVKCmdCopyBuffer<N>::encode(MVKCommandEncoder* cmdEncoder) {
 	id<MTLBuffer> srcMTLBuff = _srcBuffer->getMTLBuffer();
@@ -1023,39 +1057,75 @@ void MVKCmdCopyBuffer<N>::encode(MVKCommandEncoder* cmdEncoder) {
 
 	VkDeviceSize buffAlign = cmdEncoder->getMetalFeatures().mtlCopyBufferAlignment;
 
+	// Split each region into an aligned body, copied by blit, and unaligned head and tail
+	// fragments, copied by compute. Vulkan copy regions may not overlap, so all compute
+	// fragments can be encoded together, ahead of all blit bodies, to avoid encoder switches.
+	MVKSmallVector<MVKBufferCopyPlan, N> cpyPlans;
+	cpyPlans.reserve(_bufferCopyRegions.size());
+	bool hasComputeCopy = false;
 	for (const auto& cpyRgn : _bufferCopyRegions) {
-		const bool useComputeCopy = buffAlign > 1 && (cpyRgn.srcOffset % buffAlign != 0 ||
-													  cpyRgn.dstOffset % buffAlign != 0 ||
-													  cpyRgn.size      % buffAlign != 0);
-		if (useComputeCopy) {
-			MVKAssert(mvkFits<uint32_t>(cpyRgn.srcOffset) && mvkFits<uint32_t>(cpyRgn.dstOffset) && mvkFits<uint32_t>(cpyRgn.size),
-					  "Byte-aligned buffer copy region offsets and size must each fit into a 32-bit unsigned integer.");
-
-			MVKCmdCopyBufferInfo copyInfo;
-			copyInfo.srcOffset = (uint32_t)cpyRgn.srcOffset;
-			copyInfo.dstOffset = (uint32_t)cpyRgn.dstOffset;
-			copyInfo.size = (uint32_t)cpyRgn.size;
-
-			id<MTLComputeCommandEncoder> mtlComputeEnc = cmdEncoder->getMTLComputeEncoder(kMVKCommandUseCopyBuffer);
-			MVKMetalComputeCommandEncoderState& state = cmdEncoder->getMtlCompute();
-			[mtlComputeEnc pushDebugGroup: @"vkCmdCopyBuffer"];
-			state.bindPipeline(mtlComputeEnc, cmdEncoder->getCommandEncodingPool()->getCmdCopyBufferBytesMTLComputePipelineState());
-			state.bindBuffer(mtlComputeEnc, srcMTLBuff, srcMTLBuffOffset, 0);
-			state.bindBuffer(mtlComputeEnc, dstMTLBuff, dstMTLBuffOffset, 1);
-			state.bindStructBytes(mtlComputeEnc, &copyInfo, 2);
-			[mtlComputeEnc dispatchThreadgroups: MTLSizeMake(1, 1, 1) threadsPerThreadgroup: MTLSizeMake(1, 1, 1)];
-			[mtlComputeEnc popDebugGroup];
-		} else {
-			id<MTLBlitCommandEncoder> mtlBlitEnc = cmdEncoder->getMTLBlitEncoder(kMVKCommandUseCopyBuffer);
-			[mtlBlitEnc copyFromBuffer: srcMTLBuff
-						  sourceOffset: (srcMTLBuffOffset + cpyRgn.srcOffset)
-							  toBuffer: dstMTLBuff
-					 destinationOffset: (dstMTLBuffOffset + cpyRgn.dstOffset)
-								  size: cpyRgn.size];
+		cpyPlans.push_back(mvkPlanBufferCopy(cpyRgn.srcOffset, cpyRgn.dstOffset, cpyRgn.size, buffAlign));
+		const auto& plan = cpyPlans.back();
+		if (plan.head.size || plan.tail.size) { hasComputeCopy = true; }
+	}
+
+	if (hasComputeCopy) {
+		id<MTLComputePipelineState> cps = cmdEncoder->getCommandEncodingPool()->getCmdCopyBufferBytesMTLComputePipelineState();
+		id<MTLComputeCommandEncoder> mtlComputeEnc = cmdEncoder->getMTLComputeEncoder(kMVKCommandUseCopyBuffer);
+		MVKMetalComputeCommandEncoderState& state = cmdEncoder->getMtlCompute();
+		[mtlComputeEnc pushDebugGroup: @"vkCmdCopyBuffer"];
+		state.bindPipeline(mtlComputeEnc, cps);
+		state.bindBuffer(mtlComputeEnc, srcMTLBuff, srcMTLBuffOffset, 0);
+		state.bindBuffer(mtlComputeEnc, dstMTLBuff, dstMTLBuffOffset, 1);
+		for (const auto& plan : cpyPlans) {
+			encodeComputeCopy(cmdEncoder, mtlComputeEnc, cps, plan.head);
+			encodeComputeCopy(cmdEncoder, mtlComputeEnc, cps, plan.tail);
 		}
+		[mtlComputeEnc popDebugGroup];
+	}
+
+	for (const auto& plan : cpyPlans) {
+		if (plan.body.size == 0) { continue; }
+
+		id<MTLBlitCommandEncoder> mtlBlitEnc = cmdEncoder->getMTLBlitEncoder(kMVKCommandUseCopyBuffer);
+		[mtlBlitEnc copyFromBuffer: srcMTLBuff
+					  sourceOffset: (srcMTLBuffOffset + plan.body.srcOffset)
+						  toBuffer: dstMTLBuff
+				 destinationOffset: (dstMTLBuffOffset + plan.body.dstOffset)
+							  size: plan.body.size];
 	}
 }
 
+// Each compute thread copies a chunk of kMVKCopyBufferBytesPerThread bytes, and strides across
+// the grid for spans larger than the dispatched grid. Cap the grid so that very large, relatively
+// misaligned copies don't dispatch an excessive number of threadgroups.
+static constexpr VkDeviceSize kMVKCopyBufferBytesPerThread = 16;
+static constexpr NSUInteger kMVKCopyBufferMaxThreadgroupCount = 1024;
+
+template <size_t N>
+void MVKCmdCopyBuffer<N>::encodeComputeCopy(MVKCommandEncoder* cmdEncoder,
+											id<MTLComputeCommandEncoder> mtlComputeEnc,
+											id<MTLComputePipelineState> cps,
+											const MVKBufferCopySpan& span) {
+	if (span.size == 0) { return; }
+
+	MVKCmdCopyBufferInfo copyInfo;
+	copyInfo.srcOffset = span.srcOffset;
+	copyInfo.dstOffset = span.dstOffset;
+	copyInfo.size = span.size;
+	cmdEncoder->getMtlCompute().bindStructBytes(mtlComputeEnc, &copyInfo, 2);
+
+	// Some GPU's report different values for max threadgroup width between the pipeline state and device,
+	// so conservatively use the minimum of these two reported values.
+	NSUInteger tgWidth = std::min(cps.maxTotalThreadsPerThreadgroup, cmdEncoder->getMTLDevice().maxThreadsPerThreadgroup.width);
+	VkDeviceSize threadCount = mvkCeilingDivide(span.size, kMVKCopyBufferBytesPerThread);
+	if (threadCount < tgWidth) { tgWidth = (NSUInteger)threadCount; }
+	NSUInteger tgCount = (NSUInteger)std::min<VkDeviceSize>(mvkCeilingDivide(threadCount, (VkDeviceSize)tgWidth), kMVKCopyBufferMaxThreadgroupCount);
+
+	[mtlComputeEnc dispatchThreadgroups: MTLSizeMake(tgCount, 1, 1)
+				  threadsPerThreadgroup: MTLSizeMake(tgWidth, 1, 1)];
+}
+
 template class MVKCmdCopyBuffer<1>;
 template class MVKCmdCopyBuffer<4>;
 
@@ -1087,6 +1157,7 @@ VkResult MVKCmdBufferImageCopy<N>::setContent(MVKCommandBuffer* cmdBuff,
         };
         _bufferImageCopyRegions.emplace_back(std::move(region2));
     }
+	coalesceRegions(cmdBuff);
 
 	return validate(cmdBuff);
 }
@@ -1101,6 +1172,7 @@ VkResult MVKCmdBufferImageCopy<N>::setContent(MVKCommandBuffer* cmdBuff,
     _bufferImageCopyRegions.clear();     // Clear for reuse
     _bufferImageCopyRegions.resize(pCopyBufferToImageInfo->regionCount);
     std::memcpy(_bufferImageCopyRegions.data(), pCopyBufferToImageInfo->pRegions, pCopyBufferToImageInfo->regionCount * sizeof(VkBufferImageCopy2));
+	coalesceRegions(cmdBuff);
     return validate(cmdBuff);
 }
 
@@ -1114,9 +1186,28 @@ VkResult MVKCmdBufferImageCopy<N>::setContent(MVKCommandBuffer* cmdBuff,
     _bufferImageCopyRegions.clear();     // Clear for reuse
     _bufferImageCopyRegions.resize(pCopyImageToBufferInfo->regionCount);
     std::memcpy(_bufferImageCopyRegions.data(), pCopyImageToBufferInfo->pRegions, pCopyImageToBufferInfo->regionCount * sizeof(VkBufferImageCopy2));
+	coalesceRegions(cmdBuff);
     return validate(cmdBuff);
 }
 
+// Merge regions that copy consecutive rows of the same image subresource to or from consecutive buffer rows.
+// Combined depth-stencil formats adjust the buffer layout per aspect, and block formats may copy partial
+// blocks at the edge of a region, so regions using those formats are not merged.
+template <size_t N>
+void MVKCmdBufferImageCopy<N>::coalesceRegions(MVKCommandBuffer* cmdBuff) {
+	MVKPixelFormats* pixFmts = cmdBuff->getPixelFormats();
+	uint32_t rgnCnt = mvkCoalesceBufferImageCopyRegions(_bufferImageCopyRegions, [&](const VkBufferImageCopy2& cpyRgn) -> size_t {
+		MTLPixelFormat mtlPixFmt = _image->getMTLPixelFormat(MVKImage::getPlaneFromVkImageAspectFlags(cpyRgn.imageSubresource.aspectMask));
+		if (pixFmts->isDepthFormat(mtlPixFmt) && pixFmts->isStencilFormat(mtlPixFmt)) { return 0; }
+		if (pixFmts->getBlockTexelSize(mtlPixFmt).height != 1) { return 0; }
+
+		uint32_t buffImgWd = cpyRgn.bufferRowLength;
+		if (buffImgWd == 0) { buffImgWd = cpyRgn.imageExtent.width; }
+		return pixFmts->getBytesPerRow(mtlPixFmt, buffImgWd);
+	});
+	cmdBuff->recordCoalescedCopyRegions(rgnCnt);
+}
+
 template <size_t N>
 inline VkResult MVKCmdBufferImageCopy<N>::validate(MVKCommandBuffer *cmdBuff) {
     for (auto& region : _bufferImageCopyRegions) {
@@ -1767,33 +1858,45 @@ VkResult MVKCmdUpdateBuffer::setContent(MVKCommandBuffer* cmdBuff,
     _dstOffset = dstOffset;
     _dataSize = dataSize;
 
-    _srcDataCache.reserve(_dataSize);
-    memcpy(_srcDataCache.data(), pData, _dataSize);
+	// Write the data directly into GPU-visible memory owned by the command buffer, from which it can be
+	// copied each time the command buffer is executed. Vulkan requires the size to be a multiple of 4,
+	// so consecutive updates are packed contiguously, which allows them to be merged into a single copy.
+	NSUInteger srcAlign = std::max<NSUInteger>(cmdBuff->getMetalFeatures().mtlCopyBufferAlignment, 4);
+	auto srcData = cmdBuff->uploadData(pData, _dataSize, srcAlign);
+	_srcMTLBuffer = srcData.mtlBuffer;
+	_srcMTLBufferOffset = srcData.offset;
 
 	return VK_SUCCESS;
 }
 
 void MVKCmdUpdateBuffer::encode(MVKCommandEncoder* cmdEncoder) {
-
     id<MTLBlitCommandEncoder> mtlBlitEnc = cmdEncoder->getMTLBlitEncoder(kMVKCommandUseUpdateBuffer);
+    [mtlBlitEnc copyFromBuffer: _srcMTLBuffer
+                  sourceOffset: _srcMTLBufferOffset
+                      toBuffer: _dstBuffer->getMTLBuffer()
+             destinationOffset: _dstBuffer->getMTLBufferOffset() + _dstOffset
+                          size: _dataSize];
+}
 
-    id<MTLBuffer> dstMTLBuff = _dstBuffer->getMTLBuffer();
-    NSUInteger dstMTLBuffOffset = _dstBuffer->getMTLBufferOffset() + _dstOffset;
-
-    // Copy data to the source MTLBuffer
-    MVKMTLBufferAllocation* srcMTLBufferAlloc = cmdEncoder->getCommandEncodingPool()->acquireMTLBufferAllocation(_dataSize);
-    void* pBuffData = srcMTLBufferAlloc->getContents();
-    memcpy(pBuffData, _srcDataCache.data(), _dataSize);
+// If this command immediately follows an update of the preceding range of the same buffer,
+// from the preceding uploaded data, extend that command to cover this update, and drop this command.
+MVKCommandCompaction MVKCmdUpdateBuffer::getCompaction(MVKCommandBuffer* cmdBuff) {
+	auto* prevCmd = cmdBuff->getMergeableUpdateBufferCommand();
+	if (prevCmd && prevCmd->merge(this)) {
+		cmdBuff->recordCoalescedCopyRegions(1);
+		return MVKCommandCompactionDrop;
+	}
+	cmdBuff->recordUpdateBuffer(this);
+	return MVKCommandCompactionNone;
+}
 
-    [mtlBlitEnc copyFromBuffer: srcMTLBufferAlloc->_mtlBuffer
-                  sourceOffset: srcMTLBufferAlloc->_offset
-                      toBuffer: dstMTLBuff
-             destinationOffset: dstMTLBuffOffset
-                          size: _dataSize];
+bool MVKCmdUpdateBuffer::merge(MVKCmdUpdateBuffer* nextCmd) {
+	if (nextCmd->_dstBuffer != _dstBuffer ||
+		nextCmd->_dstOffset != _dstOffset + _dataSize ||
+		nextCmd->_srcMTLBuffer != _srcMTLBuffer ||
+		nextCmd->_srcMTLBufferOffset != _srcMTLBufferOffset + _dataSize) { return false; }
 
-    // Return the MTLBuffer allocation to the pool once the command buffer is done with it
-    [cmdEncoder->_mtlCmdBuffer addCompletedHandler: ^(id<MTLCommandBuffer> mcb) {
-        srcMTLBufferAlloc->returnToPool();
-    }];
+	_dataSize += nextCmd->_dataSize;
+	return true;
 }
 
@@ -20,6 +20,8 @@
 
 
 #include "MVKObjectPool.h"
+#include "MVKInlineArray.h"
+#include "MVKSmallVector.h"
 
 class MVKCommandBuffer;
 class MVKCommandEncoder;
@@ -46,9 +48,53 @@ protected:
 };
 
 
+#pragma mark -
+#pragma mark MVKCommandStorage
+
+/**
+ * Storage, owned by a command buffer, for commands that are allocated together with their
+ * variable-length arguments, which are stored inline after the command in the same allocation.
+ *
+ * Storage is allocated from blocks, which are retained for reuse when the command buffer
+ * is reset, and freed when this instance is trimmed or destroyed. This class is not thread-safe.
+ */
+class MVKCommandStorage {
+
+public:
+
+	/** Returns storage of the specified size, aligned for any fundamental type. */
+	void* allocate(size_t byteCount);
+
+	/** Makes all storage available for reuse. All commands in the storage must already have been destroyed. */
+	void reset();
+
+	/** Frees the blocks that hold no storage, except the first block. */
+	void trim();
+
+	~MVKCommandStorage();
+
+protected:
+	typedef struct {
+		void* data;
+		size_t byteCount;
+	} MVKCommandStorageBlock;
+
+	MVKSmallVector<MVKCommandStorageBlock, 4> _blocks;
+	size_t _blockIndex = 0;
+	size_t _blockOffset = 0;
+};
+
+
 #pragma mark -
 #pragma mark MVKCommand
 
+/** Indicates how a newly recorded command can be compacted into the commands already recorded. */
+typedef enum : uint8_t {
+	MVKCommandCompactionNone,			/**< The command must be added to the command buffer. */
+	MVKCommandCompactionDrop,			/**< The command cannot change any state, and can be dropped. */
+	MVKCommandCompactionReplaceLast,	/**< The command supersedes the most recently recorded command, which can be removed. */
+} MVKCommandCompaction;
+
 /**
  * Abstract class that represents a Vulkan command.
  *
@@ -67,6 +113,12 @@ public:
 	/** Encodes this command on the specified command encoder. */
 	virtual void encode(MVKCommandEncoder* cmdEncoder) = 0;
 
+	/**
+	 * Returns how this command can be compacted into the commands already recorded in the
+	 * command buffer. This is only called if recorded command compaction is enabled.
+	 */
+	virtual MVKCommandCompaction getCompaction(MVKCommandBuffer* cmdBuff) { return MVKCommandCompactionNone; }
+
 protected:
 	friend MVKCommandBuffer;
 
@@ -77,6 +129,27 @@ protected:
 };
 
 
+#pragma mark -
+#pragma mark MVKInlineCommand
+
+/**
+ * Abstract class of a Vulkan command whose variable-length arguments are held in MVKInlineArrays,
+ * allocated inline after the command, within the MVKCommandStorage of the command buffer.
+ *
+ * Instead of being pooled, each concrete subclass is created by a public static function of the form:
+ *
+ *     static MVKCmdXXX* newCommand(MVKCommandBuffer* cmdBuff, ...);
+ *
+ * which sizes the inline arrays from the argument counts, before setContent() is called.
+ * The command is destroyed in place when the command buffer releases its commands.
+ */
+class MVKInlineCommand : public MVKCommand, public MVKInlineConstructible {
+
+protected:
+	MVKCommandTypePool<MVKCommand>* getTypePool(MVKCommandPool* cmdPool) override { return nullptr; }
+};
+
+
 #pragma mark -
 #pragma mark MVKSingleValueCommand
 
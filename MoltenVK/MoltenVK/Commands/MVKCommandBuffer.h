@@ -39,6 +39,10 @@ class MVKQueryPool;
 class MVKPipeline;
 class MVKGraphicsPipeline;
 class MVKComputePipeline;
+class MVKBuffer;
+class MVKCmdUpdateBuffer;
+class MVKCmdCopyQueryPoolResults;
+struct MVKCachedRenderingObjects;
 
 typedef uint64_t MVKMTLCommandBufferID;
 
@@ -63,6 +67,7 @@ typedef struct MVKCommandEncodingContext {
 	MVKFramebuffer* getFramebuffer() { return _framebuffer; }
 	void setRenderingContext(MVKRenderPass* renderPass, MVKFramebuffer* framebuffer);
 	VkRenderingFlags getRenderingFlags() { return _renderPass ? _renderPass->getRenderingFlags() : 0; }
+	void reset();
 	~MVKCommandEncodingContext();
 
 private:
@@ -89,6 +94,79 @@ private:
 } MVKCurrentSubpassInfo;
 
 
+#pragma mark -
+#pragma mark MVKRecordedCommandState
+
+/**
+ * Tracks the dynamic state and pipeline bindings established by the commands recorded
+ * into a command buffer, so redundant commands can be dropped or merged during recording.
+ */
+typedef struct MVKRecordedCommandState {
+	VkViewport viewports[kMVKMaxViewportScissorCount];
+	VkRect2D scissors[kMVKMaxViewportScissorCount];
+	MVKCmdBindPipeline* graphicsPipelineCmd = nullptr;
+	MVKCmdBindPipeline* computePipelineCmd = nullptr;
+	MVKCommand* lastViewportsCmd = nullptr;
+	MVKCommand* lastScissorsCmd = nullptr;
+	uint32_t lastViewportsMask = 0;
+	uint32_t lastScissorsMask = 0;
+	uint32_t knownViewportsMask = 0;
+	uint32_t knownScissorsMask = 0;
+	MVKCommand* lastCopyBufferCmd = nullptr;
+	MVKBuffer* lastCopySrcBuffer = nullptr;
+	MVKBuffer* lastCopyDstBuffer = nullptr;
+	MVKArrayRef<const VkBufferCopy2> lastCopyBufferRegions;
+	MVKCmdUpdateBuffer* lastUpdateBufferCmd = nullptr;
+	MVKCmdCopyQueryPoolResults* lastCopyQueryPoolResultsCmd = nullptr;
+	uint32_t viewportsCompacted = 0;
+	uint32_t scissorsCompacted = 0;
+	uint32_t pipelineBindsCompacted = 0;
+	uint32_t copyRegionsCoalesced = 0;
+
+	/** Forgets all recorded state, but retains the compaction counts. */
+	void invalidate();
+
+	/** Forgets the recorded graphics pipeline binding. */
+	void invalidateGraphicsPipeline() { graphicsPipelineCmd = nullptr; }
+} MVKRecordedCommandState;
+
+
+#pragma mark -
+#pragma mark MVKCommandUploadArena
+
+/** A location within a MTLBuffer, holding data uploaded for use by the GPU. */
+typedef struct MVKCommandUploadRegion {
+	id<MTLBuffer> mtlBuffer = nil;
+	NSUInteger offset = 0;
+} MVKCommandUploadRegion;
+
+/**
+ * GPU-visible memory, owned by a command buffer, holding data that is written once, while commands are
+ * recorded, and read by the GPU each time the command buffer is executed. Memory is suballocated from
+ * blocks acquired from the MTLBuffer allocator of the command encoding pool, and the blocks are returned
+ * to that allocator when this instance is reset. This class is not thread-safe.
+ */
+class MVKCommandUploadArena {
+
+public:
+
+	/**
+	 * Copies the data into GPU-visible memory, at an offset that is a multiple of the specified alignment,
+	 * and returns the location of the copied data. The data remains valid until this instance is reset.
+	 */
+	MVKCommandUploadRegion upload(MVKCommandEncodingPool* encodingPool, const void* pData, NSUInteger byteCount, NSUInteger alignment);
+
+	/** Returns all memory to the allocator it was acquired from. The GPU must no longer be using the memory. */
+	void reset();
+
+	~MVKCommandUploadArena() { reset(); }
+
+protected:
+	MVKSmallVector<MVKMTLBufferAllocation*, 4> _blocks;
+	NSUInteger _blockOffset = 0;
+};
+
+
 #pragma mark -
 #pragma mark MVKCommandBuffer
 
@@ -116,6 +194,9 @@ public:
 	/** Closes this buffer from receiving commands and prepares for submission to a queue. */
 	VkResult end();
 
+	/** Frees any memory retained for recording commands that does not hold recorded commands. */
+	void trim() { _commandStorage.trim(); }
+
 	/** Adds the specified execution command at the end of this command buffer. */
 	void addCommand(MVKCommand* command);
 
@@ -125,6 +206,15 @@ public:
 	/** Returns the command pool backing this command buffer. */
 	MVKCommandPool* getCommandPool() { return _commandPool; }
 
+	/** Returns storage, owned by this command buffer, for a MVKInlineCommand and its inline arguments. */
+	void* allocateCommandStorage(size_t byteCount) { return _commandStorage.allocate(byteCount); }
+
+	/**
+	 * Copies the data into GPU-visible memory owned by this command buffer, and returns the location
+	 * of the copied data. The data remains valid until this command buffer is reset or destroyed.
+	 */
+	MVKCommandUploadRegion uploadData(const void* pData, NSUInteger byteCount, NSUInteger alignment);
+
 	/** Submit the commands in this buffer as part of the queue submission. */
 	void submit(MVKQueueCommandBufferSubmission* cmdBuffSubmit, MVKCommandEncodingContext* pEncodingContext);
 
@@ -154,6 +244,65 @@ public:
 	/** Called when a timestamp command is added. */
 	void recordTimestampCommand();
 
+	/** Called when a command that may change the effect of binding a graphics pipeline is added. */
+	void recordGraphicsPipelineStateChange();
+
+
+#pragma mark Recorded command compaction
+
+	/** Returns how a command that sets the specified viewports can be compacted. */
+	MVKCommandCompaction compactViewports(MVKCommand* cmd, uint32_t firstViewport, MVKArrayRef<const VkViewport> viewports);
+
+	/** Returns how a command that sets the specified scissors can be compacted. */
+	MVKCommandCompaction compactScissors(MVKCommand* cmd, uint32_t firstScissor, MVKArrayRef<const VkRect2D> scissors);
+
+	/** Returns how a command that binds the specified pipeline can be compacted. */
+	MVKCommandCompaction compactBindPipeline(MVKCmdBindPipeline* cmd, VkPipelineBindPoint pipelineBindPoint);
+
+	/**
+	 * Returns the regions of the buffer copy command recorded immediately before the command being
+	 * added, if that command copies between the same buffers, and can be replaced by the command being
+	 * added, once the command being added has merged those regions into its own. Otherwise, returns
+	 * an empty array.
+	 */
+	MVKArrayRef<const VkBufferCopy2> getMergeableCopyBufferRegions(MVKBuffer* srcBuffer, MVKBuffer* dstBuffer);
+
+	/** Called when a buffer copy command is added, with the final regions of that command. */
+	void recordCopyBuffer(MVKCommand* cmd, MVKBuffer* srcBuffer, MVKBuffer* dstBuffer, MVKArrayRef<const VkBufferCopy2> regions);
+
+	/**
+	 * Returns the buffer update command recorded immediately before the command being added,
+	 * if it exists, and the command being added can be merged into it. Otherwise, returns null.
+	 */
+	MVKCmdUpdateBuffer* getMergeableUpdateBufferCommand();
+
+	/** Called when a buffer update command is added. */
+	void recordUpdateBuffer(MVKCmdUpdateBuffer* cmd) { _recordedState.lastUpdateBufferCmd = cmd; }
+
+	/**
+	 * Returns the query pool results copy command recorded immediately before the command being
+	 * added, if it exists, and the command being added can be merged into it. Otherwise, returns null.
+	 */
+	MVKCmdCopyQueryPoolResults* getMergeableCopyQueryPoolResultsCommand();
+
+	/** Called when a query pool results copy command is added. */
+	void recordCopyQueryPoolResults(MVKCmdCopyQueryPoolResults* cmd) { _recordedState.lastCopyQueryPoolResultsCmd = cmd; }
+
+	/** Called when copy regions are merged into other copy regions while recording. */
+	void recordCoalescedCopyRegions(uint32_t count);
+
+
+#pragma mark Dynamic rendering object cache
+
+	/**
+	 * Called when a command that begins dynamic rendering is added. If this command buffer caches dynamic
+	 * rendering objects, they will be created in the specified cache, held by the command, when ended.
+	 */
+	void recordBeginRendering(MVKCachedRenderingObjects* pCachedObjects, const VkRenderingInfo* pRenderingInfo);
+
+	/** Called when a command that may modify the current renderpass while it is being encoded is added. */
+	void recordRenderPassModification();
+
 
 #pragma mark Tessellation constituent command management
 
@@ -194,12 +343,21 @@ protected:
 	void clearPrefilledMTLCommandBuffer();
     void releaseCommands(MVKCommand* command);
 	void releaseRecordedCommands();
+	void removeLastCommand();
+	void recordCompactionPerformance();
 	void flushImmediateCmdEncoder();
 	void checkDeferredEncoding();
 	void beginSecondaryEncoding(MVKCommandEncoder* cmdEncoder);
+	void cacheRenderingObjects();
+	void releaseCachedRenderingObjects();
 
 	MVKCommand* _head = nullptr;
 	MVKCommand* _tail = nullptr;
+	MVKCommand* _prevTail = nullptr;
+	MVKRecordedCommandState _recordedState;
+	MVKCommandStorage _commandStorage;
+	MVKCommandUploadArena _uploadArena;
+	MVKSmallVector<MVKCachedRenderingObjects*, 1> _cachedRenderingObjects;
 	MVKSmallVector<VkFormat, kMVKDefaultAttachmentCount> _secondaryInheritanceColorAttachmentFormats;
 	MVKSmallVector<uint32_t, kMVKDefaultAttachmentCount> _secondaryInheritanceColorAttachmentLocations;
 	MVKSmallVector<uint32_t, kMVKDefaultAttachmentCount> _secondaryInheritanceColorAttachmentInputIndices;
@@ -228,6 +386,9 @@ protected:
 	bool _hasSecondaryInheritanceColorAttachmentInputIndices;
 	bool _hasSecondaryInheritanceDepthAttachmentInputIndex;
 	bool _hasSecondaryInheritanceStencilAttachmentInputIndex;
+	bool _isCompactingCommands;
+	bool _isCachingRenderingObjects;
+	bool _isRenderPassModifiedWhileEncoding;
 };
 
 
@@ -275,7 +436,9 @@ public:
 	void beginNextSubpass(MVKCommand* subpassCmd, VkSubpassContents renderpassContents);
 
 	/** Begins dynamic rendering. */
-	void beginRendering(MVKCommand* rendCmd, const VkRenderingInfo* pRenderingInfo);
+	void beginRendering(MVKCommand* rendCmd,
+						const VkRenderingInfo* pRenderingInfo,
+						const MVKCachedRenderingObjects& cachedObjects);
 
 	/** Returns whether dynamic rendering is active. */
 	bool isDynamicRendering();
@@ -441,6 +604,16 @@ public:
 	/** Copy the bytes to a temporary MTLBuffer that will be returned to a pool after the command buffer is finished. */
 	const MVKMTLBufferAllocation* copyToTempMTLBufferAllocation(const void* bytes, NSUInteger length, bool isDedicated = false);
 
+	/**
+	 * Returns a temporary MTLBuffer containing the push constants. The push constants are identified by a version
+	 * that changes whenever their content changes, and are only copied to a new MTLBuffer when that version changes,
+	 * so all stages that bind the same push constant content share the same MTLBuffer.
+	 */
+	const MVKMTLBufferAllocation* getPushConstantsMTLBufferAllocation(uint64_t version, const void* bytes, NSUInteger length);
+
+	/** Tracks the number of push constant bytes uploaded to Metal while encoding. */
+	void recordPushConstantsUpload(NSUInteger length) { _pushConstantBytesUploaded += length; }
+
     /** Returns the command encoding pool. */
     MVKCommandEncodingPool* getCommandEncodingPool();
 
@@ -539,6 +712,9 @@ protected:
 	VkRect2D _renderArea;
 	MVKCommand* _lastMultiviewPassCmd;
     MVKActivatedQueries* _pActivatedQueries;
+	const MVKMTLBufferAllocation* _pushConstantsMTLBufferAllocation;
+	uint64_t _pushConstantsMTLBufferVersion;
+	uint64_t _pushConstantBytesUploaded;
 	MVKSmallVector<GPUCounterQuery, 16> _timestampStageCounterQueries;
 	MVKSmallVector<VkClearValue, kMVKDefaultAttachmentCount> _clearValues;
 	MVKSmallVector<MVKImageView*, kMVKDefaultAttachmentCount> _attachments;
@@ -66,6 +66,14 @@ void MVKCommandEncodingContext::syncFences(MVKDevice *device, id<MTLCommandBuffe
 	}
 }
 
+// Returns this instance to its initial state, so it can be reused by another submission.
+// The visibility result buffer has already been returned to the device by the time this is called.
+void MVKCommandEncodingContext::reset() {
+	firstVisibilityResultOffsetInRenderPass = 0;
+	fenceSlots = {};
+	setRenderingContext(nullptr, nullptr);
+}
+
 // Release rendering objects in case this instance is destroyed before ending the current renderpass.
 MVKCommandEncodingContext::~MVKCommandEncodingContext() {
 	setRenderingContext(nullptr, nullptr);
@@ -94,6 +102,94 @@ void MVKCurrentSubpassInfo::updateViewMask() {
 }
 
 
+#pragma mark -
+#pragma mark MVKRecordedCommandState
+
+void MVKRecordedCommandState::invalidate() {
+	graphicsPipelineCmd = nullptr;
+	computePipelineCmd = nullptr;
+	lastViewportsCmd = nullptr;
+	lastScissorsCmd = nullptr;
+	lastViewportsMask = 0;
+	lastScissorsMask = 0;
+	knownViewportsMask = 0;
+	knownScissorsMask = 0;
+	lastCopyBufferCmd = nullptr;
+	lastUpdateBufferCmd = nullptr;
+	lastCopyQueryPoolResultsCmd = nullptr;
+}
+
+
+#pragma mark -
+#pragma mark MVKCommandStorage
+
+static constexpr size_t kMVKCommandStorageBlockSize = 4 * KIBI;
+
+// Allocations are made sequentially from the current block. When the current block is exhausted, move on to the next
+// retained block that is large enough, or add a new block, which is larger than usual if the allocation needs it.
+void* MVKCommandStorage::allocate(size_t byteCount) {
+	byteCount = mvkAlignByteCount(byteCount, alignof(std::max_align_t));
+	while (_blockIndex < _blocks.size()) {
+		auto& block = _blocks[_blockIndex];
+		if (_blockOffset + byteCount <= block.byteCount) {
+			void* pData = (char*)block.data + _blockOffset;
+			_blockOffset += byteCount;
+			return pData;
+		}
+		_blockIndex++;
+		_blockOffset = 0;
+	}
+
+	size_t blockSize = std::max(byteCount, kMVKCommandStorageBlockSize);
+	_blocks.push_back({ ::operator new(blockSize), blockSize });
+	_blockIndex = _blocks.size() - 1;
+	_blockOffset = byteCount;
+	return _blocks.back().data;
+}
+
+void MVKCommandStorage::reset() {
+	_blockIndex = 0;
+	_blockOffset = 0;
+}
+
+// Blocks after the current block hold no commands. The first block is retained, because
+// nearly all command buffers need it, and most need no more.
+void MVKCommandStorage::trim() {
+	size_t keepCnt = _blockIndex + 1;
+	for (size_t blkIdx = keepCnt; blkIdx < _blocks.size(); blkIdx++) { ::operator delete(_blocks[blkIdx].data); }
+	if (keepCnt < _blocks.size()) { _blocks.resize(keepCnt); }
+}
+
+MVKCommandStorage::~MVKCommandStorage() {
+	for (auto& block : _blocks) { ::operator delete(block.data); }
+}
+
+
+#pragma mark -
+#pragma mark MVKCommandUploadArena
+
+static constexpr NSUInteger kMVKCommandUploadArenaBlockSize = 16 * KIBI;
+
+MVKCommandUploadRegion MVKCommandUploadArena::upload(MVKCommandEncodingPool* encodingPool, const void* pData, NSUInteger byteCount, NSUInteger alignment) {
+	NSUInteger offset = mvkAlignByteCount(_blockOffset, alignment);
+	if (_blocks.empty() || offset + byteCount > _blocks.back()->_length) {
+		_blocks.push_back(encodingPool->acquireMTLBufferAllocation(std::max(byteCount, kMVKCommandUploadArenaBlockSize)));
+		offset = 0;
+	}
+	MVKMTLBufferAllocation* block = _blocks.back();
+	_blockOffset = offset + byteCount;
+
+	memcpy((char*)block->getContents() + offset, pData, byteCount);
+	return { block->_mtlBuffer, block->_offset + offset };
+}
+
+void MVKCommandUploadArena::reset() {
+	for (auto* block : _blocks) { block->returnToPool(); }
+	_blocks.clear();
+	_blockOffset = 0;
+}
+
+
 #pragma mark -
 #pragma mark MVKCommandBuffer
 
@@ -107,6 +203,8 @@ VkResult MVKCommandBuffer::begin(const VkCommandBufferBeginInfo* pBeginInfo) {
 	VkCommandBufferUsageFlags usage = pBeginInfo->flags;
 	_isReusable = !mvkAreAllFlagsEnabled(usage, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
 	_supportsConcurrentExecution = mvkAreAllFlagsEnabled(usage, VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT);
+	_isCompactingCommands = getMVKConfig().compactRecordedCommands;
+	_isCachingRenderingObjects = _isReusable && !_isSecondary && getMVKConfig().cacheDynamicRenderingObjects;
 
 	// If this is a secondary command buffer, and contains inheritance info, set the inheritance info and determine
 	// whether it contains render pass continuation info. Otherwise, clear the inheritance info, and ignore it.
@@ -194,7 +292,12 @@ void MVKCommandBuffer::beginSecondaryEncoding(MVKCommandEncoder* cmdEncoder) {
 void MVKCommandBuffer::releaseCommands(MVKCommand* command) {
     while(command) {
         MVKCommand* nextCommand = command->_next; // Establish next before returning current to pool.
-        (command->getTypePool(getCommandPool()))->returnObject(command);
+        auto* typePool = command->getTypePool(getCommandPool());
+        if (typePool) {
+            typePool->returnObject(command);
+        } else {
+            command->~MVKCommand();		// MVKInlineCommand is destroyed in place, within _commandStorage.
+        }
         command = nextCommand;
     }
 }
@@ -203,6 +306,28 @@ void MVKCommandBuffer::releaseRecordedCommands() {
     releaseCommands(_head);
 	_head = nullptr;
 	_tail = nullptr;
+	_prevTail = nullptr;
+	_commandStorage.reset();
+	_uploadArena.reset();
+}
+
+MVKCommandUploadRegion MVKCommandBuffer::uploadData(const void* pData, NSUInteger byteCount, NSUInteger alignment) {
+	return _uploadArena.upload(_commandPool->getCommandEncodingPool(), pData, byteCount, alignment);
+}
+
+// Removes and releases the most recently added command. This can only be called
+// once after each command is added, because the previous tail is not retained.
+void MVKCommandBuffer::removeLastCommand() {
+	MVKCommand* lastCmd = _tail;
+	_tail = _prevTail;
+	_prevTail = nullptr;
+	if (_tail) {
+		_tail->_next = nullptr;
+	} else {
+		_head = nullptr;
+	}
+	_commandCount--;
+	releaseCommands(lastCmd);
 }
 
 void MVKCommandBuffer::flushImmediateCmdEncoder() {
@@ -219,6 +344,7 @@ void MVKCommandBuffer::flushImmediateCmdEncoder() {
 VkResult MVKCommandBuffer::reset(VkCommandBufferResetFlags flags) {
     flushImmediateCmdEncoder();
 	clearPrefilledMTLCommandBuffer();
+	releaseCachedRenderingObjects();
 	releaseRecordedCommands();
 	_secondaryInheritanceInfo = {};
 	_hasSecondaryInheritanceInfo = false;
@@ -244,18 +370,22 @@ VkResult MVKCommandBuffer::reset(VkCommandBufferResetFlags flags) {
 	_needsVisibilityResultMTLBuffer = false;
 	_hasStageCounterTimestampCommand = false;
 	_lastTessellationPipeline = nullptr;
+	_recordedState = {};
+	_isCompactingCommands = false;
+	_isCachingRenderingObjects = false;
+	_isRenderPassModifiedWhileEncoding = false;
 	setConfigurationResult(VK_NOT_READY);
 
-	if (mvkAreAllFlagsEnabled(flags, VK_COMMAND_BUFFER_RESET_RELEASE_RESOURCES_BIT)) {
-		// TODO: what are we releasing or returning here?
-	}
+	if (mvkAreAllFlagsEnabled(flags, VK_COMMAND_BUFFER_RESET_RELEASE_RESOURCES_BIT)) { trim(); }
 
 	return VK_SUCCESS;
 }
 
 VkResult MVKCommandBuffer::end() {
 	_canAcceptCommands = false;
-    
+
+	recordCompactionPerformance();
+	cacheRenderingObjects();
     flushImmediateCmdEncoder();
 	checkDeferredEncoding();
 
@@ -285,6 +415,20 @@ void MVKCommandBuffer::addCommand(MVKCommand* command) {
         return;
     }
 
+	if (_isCompactingCommands) {
+		switch (command->getCompaction(this)) {
+			case MVKCommandCompactionDrop:
+				command->_next = nullptr;
+				releaseCommands(command);
+				return;
+			case MVKCommandCompactionReplaceLast:
+				removeLastCommand();
+				break;
+			default:
+				break;
+		}
+	}
+
 	_commandCount++;
 
     if(_immediateCmdEncoder) {
@@ -297,6 +441,7 @@ void MVKCommandBuffer::addCommand(MVKCommand* command) {
 
     if (_tail) { _tail->_next = command; }
     command->_next = nullptr;
+    _prevTail = _tail;
     _tail = command;
     if ( !_head ) { _head = command; }
 }
@@ -383,11 +528,14 @@ MVKCommandBuffer::~MVKCommandBuffer() {
 }
 
 // Promote the initial visibility buffer and indication of timestamp use from the secondary buffers.
+// The secondary buffers may change any state, so forget any state recorded for compaction.
 void MVKCommandBuffer::recordExecuteCommands(MVKArrayRef<MVKCommandBuffer*const> secondaryCommandBuffers) {
 	for (MVKCommandBuffer* cmdBuff : secondaryCommandBuffers) {
 		if (cmdBuff->_needsVisibilityResultMTLBuffer) { _needsVisibilityResultMTLBuffer = true; }
 		if (cmdBuff->_hasStageCounterTimestampCommand) { _hasStageCounterTimestampCommand = true; }
 	}
+	_recordedState.invalidate();
+	recordRenderPassModification();
 }
 
 // Track whether a stage-based timestamp command has been added, so we know
@@ -397,11 +545,191 @@ void MVKCommandBuffer::recordTimestampCommand() {
 }
 
 
+// Binding a graphics pipeline can update render pass state, such as color attachment
+// locations, so a rebinding of the same graphics pipeline is no longer redundant.
+void MVKCommandBuffer::recordGraphicsPipelineStateChange() {
+	_recordedState.invalidateGraphicsPipeline();
+}
+
+
+#pragma mark -
+#pragma mark Recorded command compaction
+
+// Updates the recorded values of a dynamic state array, and returns how the command that sets the values can be compacted.
+// If all values set by the command match known recorded values, the command cannot change state and can be dropped.
+// If the command immediately follows a command that set the same or a subset of the same array elements,
+// the earlier values can never be observed, and the new command can replace the earlier command.
+template <typename T>
+static MVKCommandCompaction compactDynamicStateArray(MVKCommand* cmd,
+													 MVKCommand* tailCmd,
+													 bool canReplaceTail,
+													 uint32_t firstIndex,
+													 MVKArrayRef<const T> values,
+													 T* recordedValues,
+													 uint32_t& knownMask,
+													 MVKCommand*& lastCmd,
+													 uint32_t& lastCmdMask,
+													 uint32_t& compactedCount) {
+	uint32_t endIndex = std::min(firstIndex + (uint32_t)values.size(), kMVKMaxViewportScissorCount);
+	if (firstIndex >= endIndex) { return MVKCommandCompactionNone; }
+
+	uint32_t valCnt = endIndex - firstIndex;
+	uint32_t cmdMask = ((1U << valCnt) - 1U) << firstIndex;
+	if (mvkAreAllFlagsEnabled(knownMask, cmdMask) && mvkAreEqual(&recordedValues[firstIndex], values.data(), valCnt)) {
+		compactedCount++;
+		return MVKCommandCompactionDrop;
+	}
+
+	mvkCopy(&recordedValues[firstIndex], values.data(), valCnt);
+	knownMask |= cmdMask;
+
+	bool canReplace = canReplaceTail && lastCmd && lastCmd == tailCmd && mvkAreAllFlagsEnabled(cmdMask, lastCmdMask);
+	if (canReplace) { compactedCount++; }
+	lastCmd = cmd;
+	lastCmdMask = cmdMask;
+	return canReplace ? MVKCommandCompactionReplaceLast : MVKCommandCompactionNone;
+}
+
+// A previously recorded command can only be replaced if it has not already been encoded.
+MVKCommandCompaction MVKCommandBuffer::compactViewports(MVKCommand* cmd, uint32_t firstViewport, MVKArrayRef<const VkViewport> viewports) {
+	return compactDynamicStateArray(cmd, _tail, !_immediateCmdEncoder, firstViewport, viewports,
+									_recordedState.viewports, _recordedState.knownViewportsMask,
+									_recordedState.lastViewportsCmd, _recordedState.lastViewportsMask,
+									_recordedState.viewportsCompacted);
+}
+
+MVKCommandCompaction MVKCommandBuffer::compactScissors(MVKCommand* cmd, uint32_t firstScissor, MVKArrayRef<const VkRect2D> scissors) {
+	return compactDynamicStateArray(cmd, _tail, !_immediateCmdEncoder, firstScissor, scissors,
+									_recordedState.scissors, _recordedState.knownScissorsMask,
+									_recordedState.lastScissorsCmd, _recordedState.lastScissorsMask,
+									_recordedState.scissorsCompacted);
+}
+
+// Rebinding the currently bound pipeline is redundant. The dropped command was already recorded as the
+// last bound pipeline during content setting, so revert to the equivalent previously recorded command.
+MVKCommandCompaction MVKCommandBuffer::compactBindPipeline(MVKCmdBindPipeline* cmd, VkPipelineBindPoint pipelineBindPoint) {
+	MVKCmdBindPipeline*& lastCmd = (pipelineBindPoint == VK_PIPELINE_BIND_POINT_GRAPHICS
+									? _recordedState.graphicsPipelineCmd
+									: _recordedState.computePipelineCmd);
+	if (lastCmd && lastCmd->getPipeline() == cmd->getPipeline()) {
+		recordBindPipeline(lastCmd);
+		_recordedState.pipelineBindsCompacted++;
+		return MVKCommandCompactionDrop;
+	}
+	lastCmd = cmd;
+	return MVKCommandCompactionNone;
+}
+
+// Copies between the same pair of distinct buffers, with no intervening commands, can be merged into a single
+// command. Without an intervening barrier, the relative order of the two copies is undefined, so the merged
+// command can freely reorder the regions of both. Copies within a single buffer are not merged, to avoid
+// reordering copies whose regions might depend on each other.
+MVKArrayRef<const VkBufferCopy2> MVKCommandBuffer::getMergeableCopyBufferRegions(MVKBuffer* srcBuffer, MVKBuffer* dstBuffer) {
+	if (_recordedState.lastCopyBufferCmd &&
+		_recordedState.lastCopyBufferCmd == _tail &&
+		_recordedState.lastCopySrcBuffer == srcBuffer &&
+		_recordedState.lastCopyDstBuffer == dstBuffer &&
+		srcBuffer != dstBuffer &&
+		!_immediateCmdEncoder) {
+		return _recordedState.lastCopyBufferRegions;
+	}
+	return {};
+}
+
+void MVKCommandBuffer::recordCopyBuffer(MVKCommand* cmd, MVKBuffer* srcBuffer, MVKBuffer* dstBuffer, MVKArrayRef<const VkBufferCopy2> regions) {
+	_recordedState.lastCopyBufferCmd = cmd;
+	_recordedState.lastCopySrcBuffer = srcBuffer;
+	_recordedState.lastCopyDstBuffer = dstBuffer;
+	_recordedState.lastCopyBufferRegions = regions;
+}
+
+MVKCmdUpdateBuffer* MVKCommandBuffer::getMergeableUpdateBufferCommand() {
+	auto* lastCmd = _recordedState.lastUpdateBufferCmd;
+	return (lastCmd && lastCmd == _tail && !_immediateCmdEncoder) ? lastCmd : nullptr;
+}
+
+MVKCmdCopyQueryPoolResults* MVKCommandBuffer::getMergeableCopyQueryPoolResultsCommand() {
+	auto* lastCmd = _recordedState.lastCopyQueryPoolResultsCmd;
+	return (lastCmd && lastCmd == _tail && !_immediateCmdEncoder) ? lastCmd : nullptr;
+}
+
+// Transfer commands can also be populated internally while encoding, which must not be counted.
+void MVKCommandBuffer::recordCoalescedCopyRegions(uint32_t count) {
+	if (_canAcceptCommands) { _recordedState.copyRegionsCoalesced += count; }
+}
+
+void MVKCommandBuffer::recordCompactionPerformance() {
+	auto& cbPerf = getPerformanceStats().commandBuffer;
+	addPerformanceCount(cbPerf.copyRegionsCoalesced, _recordedState.copyRegionsCoalesced);
+
+	if ( !_isCompactingCommands ) { return; }
+
+	addPerformanceCount(cbPerf.redundantViewportsCompacted, _recordedState.viewportsCompacted);
+	addPerformanceCount(cbPerf.redundantScissorsCompacted, _recordedState.scissorsCompacted);
+	addPerformanceCount(cbPerf.redundantPipelineBindsCompacted, _recordedState.pipelineBindsCompacted);
+}
+
+
+#pragma mark -
+#pragma mark Dynamic rendering object cache
+
+// Dynamic rendering commands in reusable primary command buffers can reuse the same transient renderpass and
+// framebuffer objects each time the command buffer is encoded, unless that renderpass can be modified while
+// it is being encoded, by suspending and resuming rendering, or by changing attachment locations or indices.
+void MVKCommandBuffer::recordBeginRendering(MVKCachedRenderingObjects* pCachedObjects, const VkRenderingInfo* pRenderingInfo) {
+	if ( !_isCachingRenderingObjects ) { return; }
+
+	if (mvkIsAnyFlagEnabled(pRenderingInfo->flags, VK_RENDERING_SUSPENDING_BIT | VK_RENDERING_RESUMING_BIT)) {
+		recordRenderPassModification();
+	} else {
+		pCachedObjects->pRenderingInfo = pRenderingInfo;
+		_cachedRenderingObjects.push_back(pCachedObjects);
+	}
+}
+
+void MVKCommandBuffer::recordRenderPassModification() {
+	_isRenderPassModifiedWhileEncoding = true;
+}
+
+// Once a reusable primary command buffer has been recorded, create the transient renderpass and framebuffer
+// objects needed by its dynamic rendering commands, so they are not created and destroyed on each submission.
+// Each command holds its own objects, so encoding it does not need to search for them. Metal command buffers
+// cannot be committed more than once, so the commands themselves are still encoded on each submission.
+// Resources and descriptor content are read when each command is encoded, so these objects are only
+// released when this command buffer is reset or re-recorded, which Vulkan requires once any object
+// it references is destroyed.
+void MVKCommandBuffer::cacheRenderingObjects() {
+	if ( !_isCachingRenderingObjects ) { return; }
+
+	if (_isRenderPassModifiedWhileEncoding) {
+		_cachedRenderingObjects.clear();
+		return;
+	}
+
+	auto* mvkDev = getDevice();
+	for (auto* pCRO : _cachedRenderingObjects) {
+		pCRO->renderPass = mvkDev->createRenderPass(pCRO->pRenderingInfo, nullptr);
+		pCRO->framebuffer = mvkDev->createFramebuffer(pCRO->pRenderingInfo, nullptr);
+	}
+}
+
+// Called before the recorded commands, which hold the cached objects, are released.
+void MVKCommandBuffer::releaseCachedRenderingObjects() {
+	for (auto* pCRO : _cachedRenderingObjects) {
+		if (pCRO->renderPass) { pCRO->renderPass->release(); }
+		if (pCRO->framebuffer) { pCRO->framebuffer->release(); }
+		*pCRO = {};
+	}
+	_cachedRenderingObjects.clear();
+}
+
+
 #pragma mark -
 #pragma mark Tessellation constituent command management
 
 void MVKCommandBuffer::recordBindPipeline(MVKCmdBindPipeline* mvkBindPipeline) {
 	_lastTessellationPipeline = mvkBindPipeline->isTessellationPipeline() ? mvkBindPipeline : nullptr;
+	if (mvkBindPipeline->hasRemappedAttachmentLocations()) { recordRenderPassModification(); }
 }
 
 
@@ -432,6 +760,10 @@ void MVKCommandEncoder::beginEncoding(id<MTLCommandBuffer> mtlCmdBuff, MVKComman
 
     _mtlCmdBuffer = mtlCmdBuff;        // not retained
 
+	_pushConstantsMTLBufferAllocation = nullptr;
+	_pushConstantsMTLBufferVersion = 0;
+	_pushConstantBytesUploaded = 0;
+
 	_cmdBuffer->setMetalObjectLabel(_mtlCmdBuffer, _cmdBuffer->_debugName);
 }
 
@@ -465,6 +797,7 @@ void MVKCommandEncoder::encodeCommandsImpl(MVKCommand* command) {
 void MVKCommandEncoder::endEncoding() {
 	endCurrentMetalEncoding();
 	finishQueries();
+	addPerformanceCount(getPerformanceStats().commandBuffer.pushConstantBytesUploaded, _pushConstantBytesUploaded);
 }
 
 void MVKCommandEncoder::encodeSecondary(MVKCommandBuffer* secondaryCmdBuffer) {
@@ -476,7 +809,9 @@ void MVKCommandEncoder::encodeSecondary(MVKCommandBuffer* secondaryCmdBuffer) {
 	}
 }
 
-void MVKCommandEncoder::beginRendering(MVKCommand* rendCmd, const VkRenderingInfo* pRenderingInfo) {
+void MVKCommandEncoder::beginRendering(MVKCommand* rendCmd,
+									   const VkRenderingInfo* pRenderingInfo,
+									   const MVKCachedRenderingObjects& cachedObjects) {
 
 	VkSubpassContents contents = (mvkIsAnyFlagEnabled(pRenderingInfo->flags, VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT)
 								  ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS
@@ -504,14 +839,20 @@ void MVKCommandEncoder::beginRendering(MVKCommand* rendCmd, const VkRenderingInf
 	MVKFramebuffer* mvkFB;
 	bool isResumingSuspended = (mvkIsAnyFlagEnabled(_pEncodingContext->getRenderingFlags(), VK_RENDERING_SUSPENDING_BIT) &&
 								mvkIsAnyFlagEnabled(pRenderingInfo->flags, VK_RENDERING_RESUMING_BIT));
+	// Reusable command buffers may have cached the renderpass and framebuffer objects when recorded.
+	bool isTransient = false;
 	if (isResumingSuspended) {
 		mvkRP = _pEncodingContext->getRenderPass();
 		mvkRP->setRenderingFlags(pRenderingInfo->flags);
 		mvkFB = _pEncodingContext->getFramebuffer();
+	} else if (cachedObjects.renderPass) {
+		mvkRP = cachedObjects.renderPass;
+		mvkFB = cachedObjects.framebuffer;
 	} else {
 		auto* mvkDev = getDevice();
 		mvkRP = mvkDev->createRenderPass(pRenderingInfo, nullptr);
 		mvkFB = mvkDev->createFramebuffer(pRenderingInfo, nullptr);
+		isTransient = true;
 	}
 	beginRenderpass(rendCmd, contents, mvkRP, mvkFB,
 					pRenderingInfo->renderArea,
@@ -523,7 +864,7 @@ void MVKCommandEncoder::beginRendering(MVKCommand* rendCmd, const VkRenderingInf
 	// mark the objects as transient by releasing them from their initial creation
 	// retain, so they will be destroyed when released at the end of the renderpass,
 	// which may span multiple command encoders.
-	if ( !isResumingSuspended ) {
+	if (isTransient) {
 		mvkRP->release();
 		mvkFB->release();
 	}
@@ -1189,6 +1530,20 @@ const MVKMTLBufferAllocation* MVKCommandEncoder::getTempMTLBuffer(NSUInteger len
     return mtlBuffAlloc;
 }
 
+// Temporary MTLBuffer allocations live until the Metal command buffer completes, so the
+// push constants allocation is reusable until the push constants content changes.
+const MVKMTLBufferAllocation* MVKCommandEncoder::getPushConstantsMTLBufferAllocation(uint64_t version, const void* bytes, NSUInteger length) {
+	if ( !_pushConstantsMTLBufferAllocation ||
+		_pushConstantsMTLBufferVersion != version ||
+		_pushConstantsMTLBufferAllocation->_length < length) {
+
+		_pushConstantsMTLBufferAllocation = copyToTempMTLBufferAllocation(bytes, length);
+		_pushConstantsMTLBufferVersion = version;
+		recordPushConstantsUpload(length);
+	}
+	return _pushConstantsMTLBufferAllocation;
+}
+
 MVKCommandEncodingPool* MVKCommandEncoder::getCommandEncodingPool() {
 	return _cmdBuffer->getCommandPool()->getCommandEncodingPool();
 }
@@ -1355,6 +1710,9 @@ MVKCommandEncoder::MVKCommandEncoder(MVKCommandBuffer* cmdBuffer, MVKPrefillMeta
 	_pEncodingContext = nullptr;
 	_stageCountersMTLFence = nil;
 	_flushCount = 0;
+	_pushConstantsMTLBufferAllocation = nullptr;
+	_pushConstantsMTLBufferVersion = 0;
+	_pushConstantBytesUploaded = 0;
 }
 
 MVKCommandEncoder::~MVKCommandEncoder() {
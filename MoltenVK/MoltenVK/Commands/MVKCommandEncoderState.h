@@ -118,6 +118,9 @@ struct MVKVertexBufferBinder {
 /** Tracks state that's shared across both render and compute bind points. */
 struct MVKVulkanSharedCommandEncoderState {
 	MVKSmallVector<uint8_t, 128> _pushConstants;
+	uint64_t _pushConstantsVersion = 0;		/**< Incremented each time the content of _pushConstants changes. */
+	uint64_t _graphicsPushConstantsVersion = 0;	/**< The version of _pushConstants last bound to the graphics bind point. */
+	uint64_t _computePushConstantsVersion = 0;	/**< The version of _pushConstants last bound to the compute bind point. */
 };
 
 struct MVKImplicitBufferData {
@@ -481,8 +484,12 @@ public:
 	void setGraphicsEmulatedReversedDepthViewportMask(uint32_t mask);
 	/** Binds the given compute pipeline to the Vulkan graphics state, invalidating any necessary resources. */
 	void bindComputePipeline(MVKComputePipeline* pipeline);
-	/** Binds the given push constants to the Vulkan state, invalidating any necessary resources. */
-	void pushConstants(uint32_t offset, uint32_t size, const void* data);
+	/**
+	 * Binds the given push constants to the Vulkan state, invalidating any necessary resources.
+	 * The resources are only invalidated for the bind points that can consume the given stages,
+	 * and only if those bind points have not already been bound to the current content.
+	 */
+	void pushConstants(VkShaderStageFlags stageFlags, uint32_t offset, uint32_t size, const void* data);
 	/** Binds the given descriptor sets to the Vulkan state, invalidating any necessary resources. */
 	void bindDescriptorSets(VkPipelineBindPoint bindPoint,
 	                        MVKPipelineLayout* layout,
@@ -415,6 +415,23 @@ static void bindImmediateData(id<MTLCommandEncoder> encoder,
 	bindImmediateData(encoder, mvkEncoder, reinterpret_cast<const uint8_t*>(data.data()), data.byteSize(), idx, binder);
 }
 
+// Push constants are shared by all stages. If they are too large to be bound inline, the encoder copies each version
+// of their content to a temporary MTLBuffer once, and binds that same MTLBuffer to each stage that consumes them.
+static void bindPushConstants(id<MTLCommandEncoder> encoder,
+                              MVKCommandEncoder& mvkEncoder,
+                              const MVKVulkanSharedCommandEncoderState& vkShared,
+                              size_t size,
+                              uint32_t idx,
+                              const MVKResourceBinder& RESTRICT binder) {
+	if (size < 4096) {
+		binder.setBytes(encoder, vkShared._pushConstants.data(), size, idx);
+		mvkEncoder.recordPushConstantsUpload(size);
+	} else {
+		const MVKMTLBufferAllocation* alloc = mvkEncoder.getPushConstantsMTLBufferAllocation(vkShared._pushConstantsVersion, vkShared._pushConstants.data(), size);
+		binder.setBuffer(encoder, alloc->_mtlBuffer, alloc->_offset, idx);
+	}
+}
+
 /** Updates a value at the given index in the given vector, resizing if needed. */
 template<class V>
 static void updateImplicitBuffer(V &contents, uint32_t index, uint32_t value) {
@@ -632,7 +649,7 @@ static void bindMetalResources(id<MTLCommandEncoder> encoder,
                                const MVKVulkanCommonEncoderState& common,
                                const MVKPipelineStageResourceInfo& resources,
                                const MVKImplicitBufferData& implicitBufferData,
-                               const uint8_t* pushConstants,
+                               const MVKVulkanSharedCommandEncoderState& vkShared,
                                MVKShaderStage vkStage,
                                MVKResourceUsageStages useResourceStage,
                                MVKStageResourceBits& exists,
@@ -677,7 +694,7 @@ static void bindMetalResources(id<MTLCommandEncoder> encoder,
 		bindings.buffers[idx] = MVKStageResourceBindings::ImplicitBuffer(buffer);
 		switch (nvbuffer) {
 			case MVKNonVolatileImplicitBuffer::PushConstant:
-				bindImmediateData(encoder, mvkEncoder, pushConstants, common._layout->getPushConstantsLength(), idx, binder);
+				bindPushConstants(encoder, mvkEncoder, vkShared, common._layout->getPushConstantsLength(), idx, binder);
 				break;
 			case MVKNonVolatileImplicitBuffer::Swizzle:
 				bindImmediateData(encoder, mvkEncoder, getImplicitBindingData(implicitBufferData.textureSwizzles, resourceCounts.textureIndex), idx, binder);
@@ -736,7 +753,7 @@ static void bindVulkanGraphicsToMetalGraphics(
 	                   vkState,
 	                   pipeline->getStageResources(vkStage),
 	                   vkState._implicitBufferData[vkStage],
-	                   vkShared._pushConstants.data(),
+	                   vkShared,
 	                   vkStage,
 	                   getUseResourceStage(mtlStage),
 	                   mtlState._exists[mtlStage],
@@ -762,7 +779,7 @@ static void bindVulkanGraphicsToMetalCompute(
 	                   vkState,
 	                   pipeline->getStageResources(vkStage),
 	                   vkState._implicitBufferData[vkStage],
-	                   vkShared._pushConstants.data(),
+	                   vkShared,
 	                   vkStage,
 	                   MVKResourceUsageStages::Compute,
 	                   mtlState._exists,
@@ -783,7 +800,7 @@ static void bindVulkanComputeToMetalCompute(
 	                   vkState,
 	                   pipeline->getStageResources(),
 	                   vkState._implicitBufferData,
-	                   vkShared._pushConstants.data(),
+	                   vkShared,
 	                   kMVKShaderStageCompute,
 	                   MVKResourceUsageStages::Compute,
 	                   mtlState._exists,
@@ -1746,10 +1763,27 @@ void MVKCommandEncoderState::bindComputePipeline(MVKComputePipeline* pipeline) {
 	}
 }
 
-void MVKCommandEncoderState::pushConstants(uint32_t offset, uint32_t size, const void* data) {
-	mvkEnsureSize(_vkShared._pushConstants, offset + size);
-	memcpy(_vkShared._pushConstants.data() + offset, data, size);
-	invalidateImplicitBuffer(*this, VK_PIPELINE_BIND_POINT_ALL, MVKNonVolatileImplicitBuffer::PushConstant);
+// Vulkan requires that each stage that can access any of the updated bytes is included in stageFlags,
+// so bind points whose stages are not included in stageFlags do not need to upload the push constants again.
+// The whole push constant block is uploaded to each bind point, so a bind point that was skipped by an earlier
+// change must still be invalidated when it is named, even if this push does not change the shared content.
+void MVKCommandEncoderState::pushConstants(VkShaderStageFlags stageFlags, uint32_t offset, uint32_t size, const void* data) {
+	auto& pushConstants = _vkShared._pushConstants;
+	if (offset + size > pushConstants.size() || memcmp(pushConstants.data() + offset, data, size) != 0) {
+		mvkEnsureSize(pushConstants, offset + size);
+		memcpy(pushConstants.data() + offset, data, size);
+		_vkShared._pushConstantsVersion++;
+	}
+
+	uint64_t pcVersion = _vkShared._pushConstantsVersion;
+	if (mvkIsAnyFlagEnabled(stageFlags, VK_SHADER_STAGE_ALL_GRAPHICS) && _vkShared._graphicsPushConstantsVersion != pcVersion) {
+		_vkShared._graphicsPushConstantsVersion = pcVersion;
+		invalidateImplicitBuffer(*this, VK_PIPELINE_BIND_POINT_GRAPHICS, MVKNonVolatileImplicitBuffer::PushConstant);
+	}
+	if (mvkIsAnyFlagEnabled(stageFlags, VK_SHADER_STAGE_COMPUTE_BIT) && _vkShared._computePushConstantsVersion != pcVersion) {
+		_vkShared._computePushConstantsVersion = pcVersion;
+		invalidateImplicitBuffer(*this, VK_PIPELINE_BIND_POINT_COMPUTE, MVKNonVolatileImplicitBuffer::PushConstant);
+	}
 }
 
 void MVKCommandEncoderState::bindDescriptorSets(
@@ -52,11 +52,12 @@ MVKVulkanAPIObject* MVKCommandEncodingPool::getVulkanAPIObject() { return _comma
 	return rez
 
 
+// Keyed pipeline and depth-stencil states are shared across all command pools in the device.
 id<MTLRenderPipelineState> MVKCommandEncodingPool::getCmdClearMTLRenderPipelineState(MVKRPSKeyClearAtt& attKey) {
-	MVK_ENC_REZ_ACCESS(_cmdClearMTLRenderPipelineStates[attKey], newCmdClearMTLRenderPipelineState(attKey, _commandPool));
+	return _commandPool->getDevice()->getCommandResourceFactory()->getCmdClearMTLRenderPipelineState(attKey, _commandPool);
 }
 id<MTLRenderPipelineState> MVKCommandEncodingPool::getCmdBlitImageMTLRenderPipelineState(MVKRPSKeyBlitImg& blitKey) {
-	MVK_ENC_REZ_ACCESS(_cmdBlitImageMTLRenderPipelineStates[blitKey], newCmdBlitImageMTLRenderPipelineState(blitKey, _commandPool));
+	return _commandPool->getDevice()->getCommandResourceFactory()->getCmdBlitImageMTLRenderPipelineState(blitKey, _commandPool);
 }
 
 id<MTLDepthStencilState> MVKCommandEncodingPool::getMTLDepthStencilState(bool useDepth, bool useStencil) {
@@ -89,15 +90,22 @@ MVKMTLBufferAllocation* MVKCommandEncodingPool::acquireMTLBufferAllocation(NSUIn
 
 
 id<MTLDepthStencilState> MVKCommandEncodingPool::getMTLDepthStencilState(MVKMTLDepthStencilDescriptorData& dsData) {
-	MVK_ENC_REZ_ACCESS(_mtlDepthStencilStates[dsData], newMTLDepthStencilState(dsData));
+	return _commandPool->getDevice()->getCommandResourceFactory()->getMTLDepthStencilState(dsData);
 }
 
+// Looking up a map entry with operator[] can insert, so transfer resources are always looked up under the lock.
 MVKImage* MVKCommandEncodingPool::getTransferMVKImage(MVKImageDescriptorData& imgData) {
-	MVK_ENC_REZ_ACCESS(_transferImages[imgData], newMVKImage(imgData));
+	lock_guard<mutex> lock(_lock);
+	auto& mvkImg = _transferImages[imgData];
+	if ( !mvkImg ) { mvkImg = _commandPool->getDevice()->getCommandResourceFactory()->newMVKImage(imgData); }
+	return mvkImg;
 }
 
 MVKBuffer* MVKCommandEncodingPool::getTransferMVKBuffer(MVKBufferDescriptorData& buffData) {
-	MVK_ENC_REZ_ACCESS(_transferBuffers[buffData], newMVKBuffer(buffData, _transferBufferMemory[buffData]));
+	lock_guard<mutex> lock(_lock);
+	auto& mvkBuff = _transferBuffers[buffData];
+	if ( !mvkBuff ) { mvkBuff = _commandPool->getDevice()->getCommandResourceFactory()->newMVKBuffer(buffData, _transferBufferMemory[buffData]); }
+	return mvkBuff;
 }
 
 id<MTLComputePipelineState> MVKCommandEncodingPool::getCmdCopyBufferBytesMTLComputePipelineState() {
@@ -194,15 +202,6 @@ MVKCommandEncodingPool::~MVKCommandEncodingPool() {
 void MVKCommandEncodingPool::destroyMetalResources() {
 	MVKDevice* mvkDev = _commandPool->getDevice();
 
-    for (auto& pair : _cmdBlitImageMTLRenderPipelineStates) { [pair.second release]; }
-    _cmdBlitImageMTLRenderPipelineStates.clear();
-
-    for (auto& pair : _cmdClearMTLRenderPipelineStates) { [pair.second release]; }
-    _cmdClearMTLRenderPipelineStates.clear();
-
-    for (auto& pair : _mtlDepthStencilStates) { [pair.second release]; }
-    _mtlDepthStencilStates.clear();
-
     for (auto& pair : _transferImages) { mvkDev->destroyImage(pair.second, nullptr); }
     _transferImages.clear();
 
@@ -95,16 +95,31 @@ vertex VaryingsPosTexLayer vtxCmdBlitImageLayered(AttributesPosTex attributes [[
 }
 
 typedef struct {
-	uint32_t srcOffset;
-	uint32_t dstOffset;
-	uint32_t size;
+	ulong srcOffset;
+	ulong dstOffset;
+	ulong size;
 } CopyInfo;
 
+#define kCopyBufferBytesPerThread 16
+
 kernel void cmdCopyBufferBytes(device uint8_t* src [[ buffer(0) ]],
                                device uint8_t* dst [[ buffer(1) ]],
-                               constant CopyInfo& info [[ buffer(2) ]]) {
-	for (size_t i = 0; i < info.size; i++) {
-		dst[i + info.dstOffset] = src[i + info.srcOffset];
+                               constant CopyInfo& info [[ buffer(2) ]],
+                               uint pos [[thread_position_in_grid]],
+                               uint gridSize [[threads_per_grid]]) {
+	device uint8_t* srcBytes = src + info.srcOffset;
+	device uint8_t* dstBytes = dst + info.dstOffset;
+	ulong stride = ulong(gridSize) * kCopyBufferBytesPerThread;
+	for (ulong i = ulong(pos) * kCopyBufferBytesPerThread; i < info.size; i += stride) {
+		if (i + kCopyBufferBytesPerThread <= info.size) {
+			for (uint j = 0; j < kCopyBufferBytesPerThread; j++) {
+				dstBytes[i + j] = srcBytes[i + j];
+			}
+		} else {
+			for (ulong j = i; j < info.size; j++) {
+				dstBytes[j] = srcBytes[j];
+			}
+		}
 	}
 }
 
@@ -101,9 +101,12 @@ public:
 
 protected:
 	void propagateDebugName() override {}
+
+	// Declared ahead of the command buffers, so it is destroyed after them,
+	// because each command buffer returns its upload memory to it when destroyed.
+	MVKCommandEncodingPool _commandEncodingPool;
 	MVKDeviceObjectPool<MVKCommandBuffer> _commandBufferPool;
 	std::unordered_set<MVKCommandBuffer*> _allocatedCommandBuffers;
-	MVKCommandEncodingPool _commandEncodingPool;
 	uint32_t _queueFamilyIndex;
 };
 
@@ -81,10 +81,12 @@ id<MTLCommandBuffer> MVKCommandPool::getMTLCommandBuffer(MVKCommandUse cmdUse, u
 	return _device->getQueue(_queueFamilyIndex, queueIndex)->getMTLCommandBuffer(cmdUse, true);
 }
 
-// Clear the command type pool member variables.
+// Clear the command type pool member variables, and the unused command storage of each command buffer.
 void MVKCommandPool::trim() {
 #	define MVK_CMD_TYPE_POOL(cmdType)  _cmd ##cmdType ##Pool.clear();
 #	include "MVKCommandTypePools.def"
+
+	for (auto& cb : _allocatedCommandBuffers) { cb->trim(); }
 }
 
 
@@ -100,8 +102,8 @@ MVKCommandPool::MVKCommandPool(MVKDevice* device,
 #	define MVK_CMD_TYPE_POOL(cmdType)  MVK_CMD_TYPE_POOL_LAST(cmdType),
 #	include "MVKCommandTypePools.def"
 	,
-	_commandBufferPool(device, usePooling),
 	_commandEncodingPool(this),
+	_commandBufferPool(device, usePooling),
 	_queueFamilyIndex(pCreateInfo->queueFamilyIndex)
 {}
 
@@ -23,6 +23,9 @@
 #include "MVKStateTracking.h"
 #include "mvk_datatypes.hpp"
 #include <string>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
 
 #import <Metal/Metal.h>
 
@@ -279,6 +282,226 @@ namespace std {
 }
 
 
+#pragma mark -
+#pragma mark MVKConcurrentResourceCache
+
+/**
+ * A read-mostly cache of resources, keyed by a hashable key, that can be accessed from multiple threads.
+ *
+ * Looking up a resource that has already been created does not acquire a lock. Entries are stored in an
+ * open-addressed hash table, whose slots are published atomically, and are never moved or removed until
+ * the cache is cleared. When the table grows, the old table is retained until the cache is cleared,
+ * because other threads may still be reading it.
+ *
+ * If several threads request the same missing resource at the same time, only one thread creates it,
+ * and the others wait for it. Creation of different resources can proceed concurrently. If creation
+ * fails and returns nil, nothing is cached, and a later request will attempt creation again.
+ */
+template <typename K, typename V>
+class MVKConcurrentResourceCache {
+
+public:
+
+	/**
+	 * Returns the resource for the key, creating it by calling newResource(), if it has not already been created.
+	 * The cache takes ownership of the resource returned by newResource().
+	 *
+	 * If pIsFirstUse is not null, it is set to indicate whether this is the first time the resource has been
+	 * returned by this function. Resources created by preloadResource() are not considered to have been used.
+	 */
+	template <typename F>
+	V getResource(const K& key, F newResource, bool* pIsFirstUse = nullptr) {
+		V rez = nil;
+		Entry* entry = getEntry(key, newResource, rez);
+		bool isFirstUse = rez && !entry->isUsed.load(std::memory_order_relaxed) && !entry->isUsed.exchange(true, std::memory_order_relaxed);
+		if (pIsFirstUse) { *pIsFirstUse = isFirstUse; }
+		return rez;
+	}
+
+	/**
+	 * Creates the resource for the key by calling newResource(), if it has not already been created,
+	 * without marking it as used. The cache takes ownership of the resource returned by newResource().
+	 */
+	template <typename F>
+	void preloadResource(const K& key, F newResource) {
+		V rez = nil;
+		getEntry(key, newResource, rez);
+	}
+
+	/** Calls keyVisitor() with the key of each resource that has been returned by getResource(). */
+	template <typename F>
+	void forEachUsedKey(F keyVisitor) {
+		std::lock_guard<std::mutex> lock(_lock);
+		Table* table = _table.load(std::memory_order_relaxed);
+		if ( !table ) { return; }
+		for (size_t slotIdx = 0; slotIdx < table->capacity; slotIdx++) {
+			Entry* entry = table->slots[slotIdx].load(std::memory_order_relaxed);
+			if (entry && entry->isUsed.load(std::memory_order_relaxed)) { keyVisitor(entry->key); }
+		}
+	}
+
+	/**
+	 * Calls releaseResource() for each cached resource, and empties the cache.
+	 * This function must not be called while other threads are accessing the cache.
+	 */
+	template <typename F>
+	void clear(F releaseResource) {
+		std::lock_guard<std::mutex> lock(_lock);
+		Table* table = _table.load(std::memory_order_relaxed);
+		if (table) {
+			for (size_t slotIdx = 0; slotIdx < table->capacity; slotIdx++) {
+				Entry* entry = table->slots[slotIdx].load(std::memory_order_relaxed);
+				if (entry) {
+					if (entry->isReady) { releaseResource(entry->resource); }
+					delete entry;
+				}
+			}
+		}
+		for (Table* oldTable : _tables) { deleteTable(oldTable); }
+		_tables.clear();
+		_table.store(nullptr, std::memory_order_relaxed);
+		_entryCount = 0;
+	}
+
+	~MVKConcurrentResourceCache() { clear([](V rez){}); }
+
+protected:
+	typedef struct Entry {
+		Entry(const K& k, size_t h) : key(k), hash(h) {}
+		K key;
+		size_t hash;
+		V resource = nil;
+		std::atomic<bool> isReady = false;
+		std::atomic<bool> isUsed = false;
+		bool isCreating = false;
+	} Entry;
+
+	typedef struct {
+		std::atomic<Entry*>* slots;
+		size_t capacity;
+	} Table;
+
+	static constexpr size_t kMinCapacity = 16;
+
+	static Entry* findEntry(Table* table, const K& key, size_t hash) {
+		if ( !table ) { return nullptr; }
+		size_t mask = table->capacity - 1;
+		for (size_t slotIdx = hash & mask; ; slotIdx = (slotIdx + 1) & mask) {
+			Entry* entry = table->slots[slotIdx].load(std::memory_order_acquire);
+			if ( !entry ) { return nullptr; }
+			if (entry->hash == hash && entry->key == key) { return entry; }
+		}
+	}
+
+	static void insertEntry(Table* table, Entry* entry) {
+		size_t mask = table->capacity - 1;
+		size_t slotIdx = entry->hash & mask;
+		while (table->slots[slotIdx].load(std::memory_order_relaxed)) { slotIdx = (slotIdx + 1) & mask; }
+		table->slots[slotIdx].store(entry, std::memory_order_release);
+	}
+
+	static Table* newTable(size_t capacity) {
+		Table* table = new Table;
+		table->capacity = capacity;
+		table->slots = new std::atomic<Entry*>[capacity];
+		for (size_t slotIdx = 0; slotIdx < capacity; slotIdx++) { table->slots[slotIdx].store(nullptr, std::memory_order_relaxed); }
+		return table;
+	}
+
+	static void deleteTable(Table* table) {
+		delete[] table->slots;
+		delete table;
+	}
+
+	// Returns the entry for the key, creating the resource if needed, and returns the resource in rez.
+	// If creation fails, rez is nil, and the returned entry is left to be retried by a later request.
+	template <typename F>
+	Entry* getEntry(const K& key, F newResource, V& rez) {
+		size_t hash = std::hash<K>()(key);
+		Entry* entry = findEntry(_table.load(std::memory_order_acquire), key, hash);
+		if (entry && entry->isReady.load(std::memory_order_acquire)) {
+			rez = entry->resource;
+			return entry;
+		}
+
+		std::unique_lock<std::mutex> lock(_lock);
+		entry = findEntry(_table.load(std::memory_order_relaxed), key, hash);
+		if ( !entry ) { entry = addEntry(key, hash); }
+		_readyCondition.wait(lock, [entry]{ return !entry->isCreating; });
+		if (entry->isReady.load(std::memory_order_relaxed)) {
+			rez = entry->resource;
+			return entry;
+		}
+
+		entry->isCreating = true;
+		lock.unlock();
+		rez = newResource();
+		lock.lock();
+		entry->resource = rez;
+		entry->isCreating = false;
+		if (rez) { entry->isReady.store(true, std::memory_order_release); }
+		lock.unlock();
+		_readyCondition.notify_all();
+		return entry;
+	}
+
+	// Must be called while locked. Keeps the table at most half full, so probe sequences stay short.
+	Entry* addEntry(const K& key, size_t hash) {
+		Table* table = _table.load(std::memory_order_relaxed);
+		if ( !table || (_entryCount + 1) * 2 > table->capacity) {
+			Table* newTbl = newTable(table ? table->capacity * 2 : kMinCapacity);
+			if (table) {
+				for (size_t slotIdx = 0; slotIdx < table->capacity; slotIdx++) {
+					Entry* entry = table->slots[slotIdx].load(std::memory_order_relaxed);
+					if (entry) { insertEntry(newTbl, entry); }
+				}
+			}
+			_tables.push_back(newTbl);
+			_table.store(newTbl, std::memory_order_release);
+			table = newTbl;
+		}
+		Entry* entry = new Entry(key, hash);
+		insertEntry(table, entry);
+		_entryCount++;
+		return entry;
+	}
+
+	std::atomic<Table*> _table = nullptr;
+	MVKSmallVector<Table*> _tables;
+	std::mutex _lock;
+	std::condition_variable _readyCondition;
+	size_t _entryCount = 0;
+};
+
+
+#pragma mark -
+#pragma mark MVKHelperPipelineWarmupOwner
+
+/**
+ * Stands in as the owner of the helper pipeline states that are created in the background
+ * while warming up a MVKCommandResourceFactory, before any command pool has requested them.
+ * Errors that occur while creating those pipeline states are reported to the device.
+ */
+class MVKHelperPipelineWarmupOwner : public MVKVulkanAPIDeviceObject {
+
+public:
+
+	/** Returns the Vulkan type of this object. */
+	VkObjectType getVkObjectType() override { return VK_OBJECT_TYPE_UNKNOWN; }
+
+	/** Returns the debug report object type of this object. */
+	VkDebugReportObjectTypeEXT getVkDebugReportObjectType() override { return VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT; }
+
+	/** Returns the Vulkan API opaque object controlling this object. */
+	MVKVulkanAPIObject* getVulkanAPIObject() override { return _device->getVulkanAPIObject(); };
+
+	MVKHelperPipelineWarmupOwner(MVKDevice* device) : MVKVulkanAPIDeviceObject(device) {}
+
+protected:
+	void propagateDebugName() override {}
+};
+
+
 #pragma mark -
 #pragma mark MVKCommandResourceFactory
 
@@ -293,6 +516,30 @@ public:
 	/** Returns the Vulkan API opaque object controlling this object. */
 	MVKVulkanAPIObject* getVulkanAPIObject() override { return _device->getVulkanAPIObject(); };
 
+#pragma mark Shared command resources
+
+	/**
+	 * Returns a MTLRenderPipelineState to support certain Vulkan BLIT commands, creating it if needed.
+	 * The pipeline state is shared by all command pools on the device, and must not be released by the caller.
+	 */
+	id<MTLRenderPipelineState> getCmdBlitImageMTLRenderPipelineState(MVKRPSKeyBlitImg& blitKey,
+																	 MVKVulkanAPIDeviceObject* owner);
+
+	/**
+	 * Returns a MTLRenderPipelineState dedicated to rendering to several attachments to support clearing
+	 * regions of those attachments, creating it if needed. The pipeline state is shared by all command
+	 * pools on the device, and must not be released by the caller.
+	 */
+	id<MTLRenderPipelineState> getCmdClearMTLRenderPipelineState(MVKRPSKeyClearAtt& attKey,
+																 MVKVulkanAPIDeviceObject* owner);
+
+	/**
+	 * Returns a MTLDepthStencilState configured from the specified data, creating it if needed.
+	 * The state is shared by all command pools on the device, and must not be released by the caller.
+	 */
+	id<MTLDepthStencilState> getMTLDepthStencilState(MVKMTLDepthStencilDescriptorData& dsData);
+
+
 #pragma mark Command resources
 
 	/** Returns a new MTLRenderPipelineState to support certain Vulkan BLIT commands. */
@@ -394,7 +641,13 @@ public:
 
 protected:
 	void initMTLLibrary();
+	id<MTLLibrary> newPrecompiledMTLLibrary();
 	void initImageDeviceMemory();
+	void initHelperPipelineWarmup();
+	bool readHelperPipelineManifest(const char* manifestPath);
+	void writeHelperPipelineManifest(const char* manifestPath);
+	void warmUpHelperPipelines();
+	void recordHelperPipelineUse(bool wasCreated);
 	id<MTLFunction> newBlitFragFunction(MVKRPSKeyBlitImg& blitKey);
 	id<MTLFunction> newClearVertFunction(MVKRPSKeyClearAtt& attKey);
 	id<MTLFunction> newClearFragFunction(MVKRPSKeyClearAtt& attKey);
@@ -406,6 +659,15 @@ protected:
 	id<MTLComputePipelineState> newMTLComputePipelineState(const char* funcName,
 														   MVKVulkanAPIDeviceObject* owner);
 
+	MVKConcurrentResourceCache<MVKRPSKeyBlitImg, id<MTLRenderPipelineState>> _cmdBlitImageMTLRenderPipelineStates;
+	MVKConcurrentResourceCache<MVKRPSKeyClearAtt, id<MTLRenderPipelineState>> _cmdClearMTLRenderPipelineStates;
+	MVKConcurrentResourceCache<MVKMTLDepthStencilDescriptorData, id<MTLDepthStencilState>> _mtlDepthStencilStates;
+	MVKSmallVector<MVKRPSKeyBlitImg> _warmupBlitImageKeys;
+	MVKSmallVector<MVKRPSKeyClearAtt> _warmupClearKeys;
+	MVKHelperPipelineWarmupOwner* _warmupOwner = nullptr;
+	dispatch_group_t _warmupGroup = nullptr;
+	std::atomic<bool> _isWarmupCancelled = false;
 	id<MTLLibrary> _mtlLibrary;
 	MVKDeviceMemory* _transferImageMemory;
+	bool _isHelperPipelineManifestEnabled = false;
 };
@@ -24,6 +24,8 @@
 #include "MVKBuffer.h"
 #include "NSString+MoltenVK.h"
 #include "MTLRenderPipelineDescriptor+MoltenVK.h"
+#include "mvkCmdShaderLibDerived.h"
+#include <CommonCrypto/CommonDigest.h>
 
 using namespace std;
 
@@ -31,6 +33,44 @@ using namespace std;
 #pragma mark -
 #pragma mark MVKCommandResourceFactory
 
+// Helper states are cached across all command pools in the device. The owner that requests
+// a state first is used to label it and report any errors that occur while creating it.
+id<MTLRenderPipelineState> MVKCommandResourceFactory::getCmdBlitImageMTLRenderPipelineState(MVKRPSKeyBlitImg& blitKey,
+																							MVKVulkanAPIDeviceObject* owner) {
+	bool wasCreated = false;
+	bool isFirstUse = false;
+	id<MTLRenderPipelineState> mtlRPS = _cmdBlitImageMTLRenderPipelineStates.getResource(blitKey, [&]() {
+		wasCreated = true;
+		return newCmdBlitImageMTLRenderPipelineState(blitKey, owner);
+	}, &isFirstUse);
+	if (isFirstUse) { recordHelperPipelineUse(wasCreated); }
+	return mtlRPS;
+}
+
+id<MTLRenderPipelineState> MVKCommandResourceFactory::getCmdClearMTLRenderPipelineState(MVKRPSKeyClearAtt& attKey,
+																						MVKVulkanAPIDeviceObject* owner) {
+	bool wasCreated = false;
+	bool isFirstUse = false;
+	id<MTLRenderPipelineState> mtlRPS = _cmdClearMTLRenderPipelineStates.getResource(attKey, [&]() {
+		wasCreated = true;
+		return newCmdClearMTLRenderPipelineState(attKey, owner);
+	}, &isFirstUse);
+	if (isFirstUse) { recordHelperPipelineUse(wasCreated); }
+	return mtlRPS;
+}
+
+// When the helper pipeline manifest is enabled, the first use of each helper pipeline state is a hit
+// if the state was already created by the background warm-up, or a miss if it had to be created now.
+void MVKCommandResourceFactory::recordHelperPipelineUse(bool wasCreated) {
+	if ( !_isHelperPipelineManifestEnabled ) { return; }
+	auto& cbPerf = getPerformanceStats().commandBuffer;
+	addPerformanceCount(wasCreated ? cbPerf.helperPipelineWarmupMisses : cbPerf.helperPipelineWarmupHits, 1);
+}
+
+id<MTLDepthStencilState> MVKCommandResourceFactory::getMTLDepthStencilState(MVKMTLDepthStencilDescriptorData& dsData) {
+	return _mtlDepthStencilStates.getResource(dsData, [&]() { return newMTLDepthStencilState(dsData); });
+}
+
 id<MTLRenderPipelineState> MVKCommandResourceFactory::newCmdBlitImageMTLRenderPipelineState(MVKRPSKeyBlitImg& blitKey,
 																							MVKVulkanAPIDeviceObject* owner) {
 	bool isLayeredBlit = blitKey.dstSampleCount > 1 ? getMetalFeatures().multisampleLayeredRendering : getMetalFeatures().layeredRendering;
@@ -703,10 +743,15 @@ id<MTLComputePipelineState> MVKCommandResourceFactory::newMTLComputePipelineStat
 MVKCommandResourceFactory::MVKCommandResourceFactory(MVKDevice* device) : MVKBaseDeviceObject(device) {
 	initMTLLibrary();
 	initImageDeviceMemory();
+	initHelperPipelineWarmup();
 }
 
-// Initializes the Metal shaders used for command activity.
+// Initializes the Metal shaders used for command activity, from the library compiled
+// when MoltenVK was built, if possible, otherwise by compiling the shader source.
 void MVKCommandResourceFactory::initMTLLibrary() {
+	_mtlLibrary = newPrecompiledMTLLibrary();
+	if (_mtlLibrary) { return; }
+
     @autoreleasepool {
         NSError* err = nil;
 		uint64_t startTime = getPerformanceTimestamp();
@@ -718,6 +763,35 @@ void MVKCommandResourceFactory::initMTLLibrary() {
     }
 }
 
+// Returns the retained library of command shaders compiled when MoltenVK was built, or nil if the library
+// is not available, was built from different shader source, or cannot be loaded by this device. The library
+// is built with fast math enabled, so it is not used if the app has disabled fast math. The library is only
+// used if the hash of the shader source it was built from matches the hash of the source in this build.
+id<MTLLibrary> MVKCommandResourceFactory::newPrecompiledMTLLibrary() {
+	if ( !mvkCmdShaderLibSize || getMVKConfig().fastMathEnabled == MVK_CONFIG_FAST_MATH_NEVER ) { return nil; }
+
+	@autoreleasepool {
+		NSData* srcData = [_MVKStaticCmdShaderSource dataUsingEncoding: NSUTF8StringEncoding];
+		unsigned char srcHash[CC_SHA256_DIGEST_LENGTH];
+		CC_SHA256(srcData.bytes, (CC_LONG)srcData.length, srcHash);
+		if (memcmp(srcHash, mvkCmdShaderLibSourceHash, sizeof(srcHash)) != 0) { return nil; }
+
+		NSError* err = nil;
+		uint64_t startTime = getPerformanceTimestamp();
+		dispatch_data_t libData = dispatch_data_create(mvkCmdShaderLibData, mvkCmdShaderLibSize, nullptr, ^{});	// temp retain
+		id<MTLLibrary> mtlLib = [getMTLDevice() newLibraryWithData: libData error: &err];						// retained
+		dispatch_release(libData);																				// temp release
+		if (err) {
+			MVKLogInfo("Compiling command shaders from source, because the precompiled library could not be loaded (Error code %li): %s",
+					   (long)err.code, err.localizedDescription.UTF8String);
+			[mtlLib release];
+			return nil;
+		}
+		addPerformanceInterval(getPerformanceStats().shaderCompilation.mslLoad, startTime);
+		return mtlLib;
+	}
+}
+
 // Initializes the empty device memory used to back temporary VkImages.
 void MVKCommandResourceFactory::initImageDeviceMemory() {
 	VkMemoryAllocateInfo allocInfo = {
@@ -729,7 +803,127 @@ void MVKCommandResourceFactory::initImageDeviceMemory() {
 	_transferImageMemory = _device->allocateMemory(&allocInfo, nullptr);
 }
 
+// If a helper pipeline manifest is configured, reads the helper pipeline keys used during a previous
+// run, and creates their pipeline states on a background thread, before the app needs them.
+void MVKCommandResourceFactory::initHelperPipelineWarmup() {
+	const char* manifestPath = getMVKConfig().helperPipelineManifestPath;
+	_isHelperPipelineManifestEnabled = manifestPath && *manifestPath;
+	if ( !_isHelperPipelineManifestEnabled || !readHelperPipelineManifest(manifestPath) ) { return; }
+
+	_warmupOwner = new MVKHelperPipelineWarmupOwner(_device);
+	_warmupGroup = dispatch_group_create();
+	dispatch_group_async(_warmupGroup, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_BACKGROUND, 0), ^{
+		@autoreleasepool { warmUpHelperPipelines(); }
+	});
+}
+
+void MVKCommandResourceFactory::warmUpHelperPipelines() {
+	for (auto& blitKey : _warmupBlitImageKeys) {
+		if (_isWarmupCancelled.load(std::memory_order_relaxed)) { return; }
+		_cmdBlitImageMTLRenderPipelineStates.preloadResource(blitKey, [&]() { return newCmdBlitImageMTLRenderPipelineState(blitKey, _warmupOwner); });
+	}
+	for (auto& attKey : _warmupClearKeys) {
+		if (_isWarmupCancelled.load(std::memory_order_relaxed)) { return; }
+		_cmdClearMTLRenderPipelineStates.preloadResource(attKey, [&]() { return newCmdClearMTLRenderPipelineState(attKey, _warmupOwner); });
+	}
+}
+
+// The helper pipeline manifest is a header, followed by the raw content of each blit key, then each clear key.
+// The manifest is ignored if it was written by a different version of MoltenVK, or for a different GPU.
+static const uint32_t kMVKHelperPipelineManifestMagic = 0x4D564B48;		// "MVKH"
+static const uint32_t kMVKHelperPipelineManifestVersion = 1;
+
+typedef struct {
+	uint32_t magic;
+	uint32_t version;
+	uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+	uint32_t blitImageKeySize;
+	uint32_t blitImageKeyCount;
+	uint32_t clearKeySize;
+	uint32_t clearKeyCount;
+} MVKHelperPipelineManifestHeader;
+
+// The key counts are only trusted if the manifest is exactly the size they imply, so that a corrupted
+// or truncated manifest is rejected before any storage is allocated for its keys.
+bool MVKCommandResourceFactory::readHelperPipelineManifest(const char* manifestPath) {
+	FILE* file = fopen(manifestPath, "rb");
+	if ( !file ) { return false; }
+
+	long fileSize = -1;
+	if (fseek(file, 0, SEEK_END) == 0) { fileSize = ftell(file); }
+	rewind(file);
+
+	MVKHelperPipelineManifestHeader hdr;
+	bool isValid = (fileSize >= 0 &&
+					fread(&hdr, sizeof(hdr), 1, file) == 1 &&
+					hdr.magic == kMVKHelperPipelineManifestMagic &&
+					hdr.version == kMVKHelperPipelineManifestVersion &&
+					mvkAreEqual(hdr.pipelineCacheUUID, getDeviceProperties().pipelineCacheUUID, VK_UUID_SIZE) &&
+					hdr.blitImageKeySize == sizeof(MVKRPSKeyBlitImg) &&
+					hdr.clearKeySize == sizeof(MVKRPSKeyClearAtt) &&
+					uint64_t(fileSize) == (sizeof(hdr) +
+										   uint64_t(hdr.blitImageKeyCount) * sizeof(MVKRPSKeyBlitImg) +
+										   uint64_t(hdr.clearKeyCount) * sizeof(MVKRPSKeyClearAtt)));
+	if (isValid) {
+		_warmupBlitImageKeys.resize(hdr.blitImageKeyCount);
+		_warmupClearKeys.resize(hdr.clearKeyCount);
+		isValid = (fread(_warmupBlitImageKeys.data(), sizeof(MVKRPSKeyBlitImg), hdr.blitImageKeyCount, file) == hdr.blitImageKeyCount &&
+				   fread(_warmupClearKeys.data(), sizeof(MVKRPSKeyClearAtt), hdr.clearKeyCount, file) == hdr.clearKeyCount);
+	}
+	fclose(file);
+
+	if ( !isValid ) {
+		MVKLogInfo("Ignoring helper pipeline manifest %s, because it is invalid or was written for a different GPU.", manifestPath);
+		_warmupBlitImageKeys.clear();
+		_warmupClearKeys.clear();
+	}
+	return isValid && (_warmupBlitImageKeys.size() + _warmupClearKeys.size()) > 0;
+}
+
+// Writes the keys of the helper pipeline states that were used during this run. The manifest is written to
+// a temporary file, which then replaces the manifest, so a concurrent reader never sees a partial manifest.
+void MVKCommandResourceFactory::writeHelperPipelineManifest(const char* manifestPath) {
+	MVKSmallVector<MVKRPSKeyBlitImg> blitKeys;
+	MVKSmallVector<MVKRPSKeyClearAtt> clearKeys;
+	_cmdBlitImageMTLRenderPipelineStates.forEachUsedKey([&](const MVKRPSKeyBlitImg& blitKey) { blitKeys.push_back(blitKey); });
+	_cmdClearMTLRenderPipelineStates.forEachUsedKey([&](const MVKRPSKeyClearAtt& attKey) { clearKeys.push_back(attKey); });
+
+	MVKHelperPipelineManifestHeader hdr;
+	hdr.magic = kMVKHelperPipelineManifestMagic;
+	hdr.version = kMVKHelperPipelineManifestVersion;
+	mvkCopy(hdr.pipelineCacheUUID, getDeviceProperties().pipelineCacheUUID, VK_UUID_SIZE);
+	hdr.blitImageKeySize = sizeof(MVKRPSKeyBlitImg);
+	hdr.blitImageKeyCount = (uint32_t)blitKeys.size();
+	hdr.clearKeySize = sizeof(MVKRPSKeyClearAtt);
+	hdr.clearKeyCount = (uint32_t)clearKeys.size();
+
+	string tmpPath = string(manifestPath) + ".tmp";
+	FILE* file = fopen(tmpPath.c_str(), "wb");
+	if ( !file ) {
+		MVKLogWarn("Could not write helper pipeline manifest %s: %s", manifestPath, strerror(errno));
+		return;
+	}
+	bool wasWritten = (fwrite(&hdr, sizeof(hdr), 1, file) == 1 &&
+					   fwrite(blitKeys.data(), sizeof(MVKRPSKeyBlitImg), blitKeys.size(), file) == blitKeys.size() &&
+					   fwrite(clearKeys.data(), sizeof(MVKRPSKeyClearAtt), clearKeys.size(), file) == clearKeys.size());
+	wasWritten = (fclose(file) == 0) && wasWritten;
+	if (wasWritten && rename(tmpPath.c_str(), manifestPath) == 0) { return; }
+
+	MVKLogWarn("Could not write helper pipeline manifest %s: %s", manifestPath, strerror(errno));
+	unlink(tmpPath.c_str());
+}
+
 MVKCommandResourceFactory::~MVKCommandResourceFactory() {
+	if (_warmupGroup) {
+		_isWarmupCancelled = true;
+		dispatch_group_wait(_warmupGroup, DISPATCH_TIME_FOREVER);
+		dispatch_release(_warmupGroup);
+	}
+	if (_warmupOwner) { _warmupOwner->destroy(); }
+	if (_isHelperPipelineManifestEnabled) { writeHelperPipelineManifest(getMVKConfig().helperPipelineManifestPath); }
+	_cmdBlitImageMTLRenderPipelineStates.clear([](id<MTLRenderPipelineState> mtlRPS) { [mtlRPS release]; });
+	_cmdClearMTLRenderPipelineStates.clear([](id<MTLRenderPipelineState> mtlRPS) { [mtlRPS release]; });
+	_mtlDepthStencilStates.clear([](id<MTLDepthStencilState> mtlDSS) { [mtlDSS release]; });
 	[_mtlLibrary release];
 	_mtlLibrary = nil;
 	if (_transferImageMemory) { _transferImageMemory->destroy(); }
@@ -156,7 +156,7 @@ id<MTLBuffer> MVKBuffer::getMTLBuffer() {
             if (_mtlBuffer) { return _mtlBuffer; }
 			id<MTLBuffer> buf = [_deviceMemory->getMTLHeap() newBufferWithLength: getByteCount()
 			                                                             options: _deviceMemory->getMTLResourceOptions()
-			                                                              offset: _deviceMemoryOffset];	// retained
+			                                                              offset: _deviceMemory->getMTLHeapOffset() + _deviceMemoryOffset];	// retained
 			_device->makeResident(buf);
 			_device->getLiveResources().add(buf);
 			_mtlBuffer = buf;
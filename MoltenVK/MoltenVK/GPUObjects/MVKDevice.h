@@ -49,6 +49,8 @@ class MVKPresentableSwapchainImage;
 class MVKImageView;
 class MVKSwapchain;
 class MVKDeviceMemory;
+class MVKDeviceMemorySuballocator;
+class MVKHostMemoryPool;
 class MVKFence;
 class MVKSemaphore;
 class MVKTimelineSemaphore;
@@ -538,6 +540,7 @@ protected:
 typedef enum {
 	MVKActivityPerformanceValueTypeDuration,
 	MVKActivityPerformanceValueTypeByteCount,
+	MVKActivityPerformanceValueTypeCount,
 } MVKActivityPerformanceValueType;
 
 typedef struct MVKMTLBlitEncoder {
@@ -675,6 +678,12 @@ public:
     /** Returns the common resource factory for creating command resources. */
     MVKCommandResourceFactory* getCommandResourceFactory() { return _commandResourceFactory; }
 
+	/** Returns the allocator that carves small memory allocations out of larger MTLHeaps, or null if suballocation is disabled. */
+	MVKDeviceMemorySuballocator* getMemorySuballocator() { return _memorySuballocator; }
+
+	/** Returns the pool of host memory blocks that back device memory allocations. */
+	MVKHostMemoryPool* getHostMemoryPool() { return _hostMemoryPool; }
+
 	/** Returns the function pointer corresponding to the specified named entry point. */
 	PFN_vkVoidFunction getProcAddr(const char* pName);
 
@@ -887,6 +896,9 @@ public:
 							MVKCommandEncoder* cmdEncoder,
 							MVKCommandUse cmdUse);
 
+	/** Flushes the memory regions, flushing all the regions of each device memory together. */
+	VkResult flushMappedMemoryRanges(uint32_t memRangeCount, const VkMappedMemoryRange* pMemRanges);
+
 	/** Invalidates the memory regions. */
 	VkResult invalidateMappedMemoryRanges(uint32_t memRangeCount, const VkMappedMemoryRange* pMemRanges);
 
@@ -1073,6 +1085,7 @@ protected:
 	void logActivityInline(MVKPerformanceTracker& activity, MVKPerformanceStatistics& perfStats);
 	void logActivityDuration(MVKPerformanceTracker& activity, MVKPerformanceStatistics& perfStats, bool isInline = false);
 	void logActivityByteCount(MVKPerformanceTracker& activity, MVKPerformanceStatistics& perfStats, bool isInline = false);
+	void logActivityCount(MVKPerformanceTracker& activity, MVKPerformanceStatistics& perfStats, bool isInline = false);
 	void getDescriptorVariableDescriptorCountLayoutSupport(const VkDescriptorSetLayoutCreateInfo* pCreateInfo,
 														   VkDescriptorSetLayoutSupport* pSupport,
 														   VkDescriptorSetVariableDescriptorCountLayoutSupport* pVarDescSetCountSupport);
@@ -1095,6 +1108,8 @@ protected:
 
 	MVKPerformanceStatistics _performanceStats;
     MVKCommandResourceFactory* _commandResourceFactory = nullptr;
+	MVKDeviceMemorySuballocator* _memorySuballocator = nullptr;
+	MVKHostMemoryPool* _hostMemoryPool = nullptr;
 	MVKSmallVector<MVKSmallVector<MVKQueue*, kMVKQueueCountPerQueueFamily>, kMVKQueueFamilyCount> _queuesByQueueFamilyIndex;
 	MVKSmallVector<MVKResource*> _resources;
 	MVKSmallVector<MVKBuffer*> _gpuAddressableBuffers;
@@ -1207,6 +1222,13 @@ public:
 		}
 	};
 
+	/** If performance is being tracked, adds the count of occurrences of an activity to the given performance statistics. */
+	void addPerformanceCount(MVKPerformanceTracker& perfTracker, uint64_t count) {
+		if (_device->_isPerformanceTracking) {
+			_device->updateActivityPerformance(perfTracker, double(count));
+		}
+	};
+
 	/** Constructs an instance for the specified device. */
 	MVKDeviceTrackingMixin(MVKDevice* device) : _device(device) { assert(_device); }
 
@@ -3897,7 +3897,7 @@ VkResult MVKDevice::markLost(bool alsoMarkPhysicalDevice) {
 	if (alsoMarkPhysicalDevice) { _physicalDevice->setConfigurationResult(VK_ERROR_DEVICE_LOST); }
 
 	for (auto* sem4 : _awaitingSemaphores) {
-		sem4->release();
+		sem4->releaseAll();
 	}
 	for (auto& sem4AndValue : _awaitingTimelineSem4s) {
 		VkSemaphoreSignalInfo signalInfo;
@@ -4392,17 +4392,23 @@ VkResult MVKDevice::createPipelines(VkPipelineCache pipelineCache,
                                     const PipelineInfoType* pCreateInfos,
                                     const VkAllocationCallbacks* pAllocator,
                                     VkPipeline* pPipelines) {
-	bool ignoreFurtherPipelines = false;
-    VkResult rslt = VK_SUCCESS;
-    MVKPipelineCache* mvkPLC = (MVKPipelineCache*)pipelineCache;
+	MVKPipelineCache* mvkPLC = (MVKPipelineCache*)pipelineCache;
+	bool isEarlyReturnEnabled = _enabledPipelineCreationCacheControlFeatures.pipelineCreationCacheControl;
 
-	@autoreleasepool {
-		for (uint32_t plIdx = 0; plIdx < count; plIdx++) {
+	// Ensure all slots are purposefully set.
+	for (uint32_t plIdx = 0; plIdx < count; plIdx++) { pPipelines[plIdx] = VK_NULL_HANDLE; }
 
-			// Ensure all slots are purposefully set.
-			pPipelines[plIdx] = VK_NULL_HANDLE;
-			if (ignoreFurtherPipelines) { continue; }
+	// Index of the first pipeline that failed, and had the VK_PIPELINE_CREATE_EARLY_RETURN_ON_FAILURE_BIT
+	// flag set. No further pipelines are created once this is known. Updated atomically to the lowest index.
+	std::atomic<uint32_t> earlyReturnIdx = count;
+	MVKSmallVector<VkResult, 8> plRslts;
+	plRslts.assign(count, VK_SUCCESS);
+	VkResult* pPLRslts = plRslts.data();
 
+	auto createPipeline = [&](uint32_t plIdx) {
+		if (plIdx > earlyReturnIdx) { return; }
+
+		@autoreleasepool {
 			const PipelineInfoType* pCreateInfo = &pCreateInfos[plIdx];
 			const VkPipelineCreateFlags2 createFlags = MVKPipeline::getPipelineCreateFlags(pCreateInfo);
 
@@ -4422,15 +4428,60 @@ VkResult MVKDevice::createPipelines(VkPipelineCache pipelineCache,
 			if (plRslt == VK_SUCCESS) {
 				pPipelines[plIdx] = (VkPipeline)mvkPL;
 			} else {
-				// If creation was unsuccessful, destroy the broken pipeline, change the result
-				// code of this function, and if the VK_PIPELINE_CREATE_EARLY_RETURN_ON_FAILURE_BIT
-				// flag is set, don't build any further pipelines.
+				// If creation was unsuccessful, destroy the broken pipeline, record the result code,
+				// and if the VK_PIPELINE_CREATE_EARLY_RETURN_ON_FAILURE_BIT flag is set, don't build
+				// any further pipelines.
 				mvkPL->destroy();
-				if (rslt == VK_SUCCESS) { rslt = plRslt; }
-				ignoreFurtherPipelines = (_enabledPipelineCreationCacheControlFeatures.pipelineCreationCacheControl &&
-										  mvkIsAnyFlagEnabled(createFlags, VK_PIPELINE_CREATE_2_EARLY_RETURN_ON_FAILURE_BIT));
+				pPLRslts[plIdx] = plRslt;
+				if (isEarlyReturnEnabled && mvkIsAnyFlagEnabled(createFlags, VK_PIPELINE_CREATE_2_EARLY_RETURN_ON_FAILURE_BIT)) {
+					uint32_t erIdx = earlyReturnIdx;
+					while (plIdx < erIdx && !earlyReturnIdx.compare_exchange_weak(erIdx, plIdx)) {}
+				}
+			}
+		}
+	};
+
+	// Shader conversion and Metal compilation dominate pipeline creation, so when more than one pipeline
+	// is requested, create them concurrently. A derivative pipeline whose parent is in the same batch is
+	// created in a later pass than its parent. Pipelines may not be created concurrently if the app has
+	// promised to synchronize access to the pipeline cache, because the cache will not lock internally.
+	bool isConcurrent = (count > 1 &&
+						 getMVKConfig().createPipelinesConcurrently &&
+						 !(mvkPLC && mvkPLC->isExternallySynchronized()));
+	if (isConcurrent) {
+		MVKSmallVector<uint32_t, 8> plPasses;
+		plPasses.assign(count, 0);
+		uint32_t* pPLPasses = plPasses.data();
+		uint32_t passCnt = 1;
+		for (uint32_t plIdx = 0; plIdx < count; plIdx++) {
+			const PipelineInfoType* pCreateInfo = &pCreateInfos[plIdx];
+			int32_t parentPLIdx = pCreateInfo->basePipelineIndex;
+			if (mvkAreAllFlagsEnabled(MVKPipeline::getPipelineCreateFlags(pCreateInfo), VK_PIPELINE_CREATE_2_DERIVATIVE_BIT) &&
+				!pCreateInfo->basePipelineHandle && parentPLIdx >= 0 && uint32_t(parentPLIdx) < plIdx) {
+				pPLPasses[plIdx] = pPLPasses[parentPLIdx] + 1;
+				passCnt = max(passCnt, pPLPasses[plIdx] + 1);
 			}
 		}
+		dispatch_queue_t dq = dispatch_get_global_queue(qos_class_self(), 0);
+		for (uint32_t pass = 0; pass < passCnt; pass++) {
+			dispatch_apply(count, dq, ^(size_t plIdx) {
+				if (pPLPasses[plIdx] == pass) { createPipeline(uint32_t(plIdx)); }
+			});
+		}
+	} else {
+		for (uint32_t plIdx = 0; plIdx < count; plIdx++) { createPipeline(plIdx); }
+	}
+
+	// Pipelines after an early return may already have been created concurrently. Discard them,
+	// and return the result of the first pipeline that failed, as if they were created in order.
+	VkResult rslt = VK_SUCCESS;
+	for (uint32_t plIdx = 0; plIdx < count; plIdx++) {
+		if (plIdx > earlyReturnIdx) {
+			if (pPipelines[plIdx]) { ((MVKPipeline*)pPipelines[plIdx])->destroy(); }
+			pPipelines[plIdx] = VK_NULL_HANDLE;
+		} else if (rslt == VK_SUCCESS) {
+			rslt = pPLRslts[plIdx];
+		}
 	}
 
     return rslt;
@@ -4708,10 +4759,16 @@ void MVKDevice::updateActivityPerformance(MVKPerformanceTracker& activity, doubl
 }
 
 void MVKDevice::logActivityInline(MVKPerformanceTracker& activity, MVKPerformanceStatistics& perfStats) {
-	if (getActivityPerformanceValueType(activity, _performanceStats) == MVKActivityPerformanceValueTypeByteCount) {
-		logActivityByteCount(activity, _performanceStats, true);
-	} else {
-		logActivityDuration(activity, _performanceStats, true);
+	switch (getActivityPerformanceValueType(activity, _performanceStats)) {
+		case MVKActivityPerformanceValueTypeByteCount:
+			logActivityByteCount(activity, _performanceStats, true);
+			break;
+		case MVKActivityPerformanceValueTypeCount:
+			logActivityCount(activity, _performanceStats, true);
+			break;
+		default:
+			logActivityDuration(activity, _performanceStats, true);
+			break;
 	}
 }
 void MVKDevice::logActivityDuration(MVKPerformanceTracker& activity, MVKPerformanceStatistics& perfStats, bool isInline) {
@@ -4742,6 +4799,21 @@ void MVKDevice::logActivityByteCount(MVKPerformanceTracker& activity, MVKPerform
 			   activity.count);
 }
 
+void MVKDevice::logActivityCount(MVKPerformanceTracker& activity, MVKPerformanceStatistics& perfStats, bool isInline) {
+	const char* fmt = (isInline
+					   ? "%s avg: %.1f, latest: %.0f, prev: %.0f, min: %.0f, max: %.0f, total: %.0f, count: %d"
+					   : "  %-45s avg: %.1f, latest: %.0f, prev: %.0f, min: %.0f, max: %.0f, total: %.0f, count: %d");
+	MVKLogInfo(fmt,
+			   getActivityPerformanceDescription(activity, perfStats),
+			   activity.average,
+			   activity.latest,
+			   activity.previous,
+			   activity.minimum,
+			   activity.maximum,
+			   activity.average * activity.count,
+			   activity.count);
+}
+
 void MVKDevice::logPerformanceSummary() {
 
 	// Get a copy to minimize time under lock
@@ -4750,6 +4822,7 @@ void MVKDevice::logPerformanceSummary() {
 
 #define logDuration(s)   logActivityDuration(perfStats.s, perfStats)
 #define logByteCount(s)  logActivityByteCount(perfStats.s, perfStats)
+#define logCount(s)      logActivityCount(perfStats.s, perfStats)
 
 	logDuration(queue.frameInterval);
 	logDuration(queue.retrieveMTLCommandBuffer);
@@ -4758,6 +4831,9 @@ void MVKDevice::logPerformanceSummary() {
 	logDuration(queue.mtlCommandBufferExecution);
 	logDuration(queue.retrieveCAMetalDrawable);
 	logDuration(queue.presentSwapchains);
+	logCount(queue.submissionsBatched);
+	logCount(queue.activeMTLCommandBuffers);
+	logDuration(queue.waitFramePacing);
 	logDuration(shaderCompilation.hashShaderCode);
 	logDuration(shaderCompilation.spirvToMSL);
 	logDuration(shaderCompilation.mslCompile);
@@ -4772,8 +4848,18 @@ void MVKDevice::logPerformanceSummary() {
 	logDuration(pipelineCache.readPipelineCache);
 	logDuration(pipelineCache.writePipelineCache);
 	logByteCount(device.gpuMemoryAllocated);
+	logByteCount(device.hostMemoryPoolAllocated);
+	logCount(device.hostMemoryPoolReuses);
+	logCount(commandBuffer.redundantViewportsCompacted);
+	logCount(commandBuffer.redundantScissorsCompacted);
+	logCount(commandBuffer.redundantPipelineBindsCompacted);
+	logCount(commandBuffer.pushConstantBytesUploaded);
+	logCount(commandBuffer.copyRegionsCoalesced);
+	logCount(commandBuffer.helperPipelineWarmupHits);
+	logCount(commandBuffer.helperPipelineWarmupMisses);
 #undef logDuration
 #undef logByteCount
+#undef logCount
 }
 
 const char* MVKDevice::getActivityPerformanceDescription(MVKPerformanceTracker& activity, MVKPerformanceStatistics& perfStats) {
@@ -4798,13 +4884,36 @@ const char* MVKDevice::getActivityPerformanceDescription(MVKPerformanceTracker&
 	ifActivityReturnName(queue.retrieveCAMetalDrawable,            "Retrieve a CAMetalDrawable");
 	ifActivityReturnName(queue.presentSwapchains,                  "Present swapchains in on GPU");
 	ifActivityReturnName(queue.frameInterval,                      "Frame interval");
+	ifActivityReturnName(queue.submissionsBatched,                 "Queue submissions batched");
+	ifActivityReturnName(queue.activeMTLCommandBuffers,            "Active MTLCommandBuffers");
+	ifActivityReturnName(queue.waitFramePacing,                    "Wait for frame pacing");
 	ifActivityReturnName(device.gpuMemoryAllocated,                "GPU memory allocated");
+	ifActivityReturnName(device.hostMemoryPoolAllocated,           "Host memory pool allocated");
+	ifActivityReturnName(device.hostMemoryPoolReuses,              "Host memory pool block reuses");
+	ifActivityReturnName(commandBuffer.redundantViewportsCompacted,     "Redundant viewport commands compacted");
+	ifActivityReturnName(commandBuffer.redundantScissorsCompacted,      "Redundant scissor commands compacted");
+	ifActivityReturnName(commandBuffer.redundantPipelineBindsCompacted, "Redundant pipeline binds compacted");
+	ifActivityReturnName(commandBuffer.pushConstantBytesUploaded,       "Push constant bytes uploaded");
+	ifActivityReturnName(commandBuffer.copyRegionsCoalesced,            "Copy regions coalesced");
+	ifActivityReturnName(commandBuffer.helperPipelineWarmupHits,        "Helper pipeline warm-up hits");
+	ifActivityReturnName(commandBuffer.helperPipelineWarmupMisses,      "Helper pipeline warm-up misses");
 	return                                                         "Unknown performance activity";
 #undef ifActivityReturnName
 }
 
 MVKActivityPerformanceValueType MVKDevice::getActivityPerformanceValueType(MVKPerformanceTracker& activity, MVKPerformanceStatistics& perfStats) {
-	if (&activity == &perfStats.device.gpuMemoryAllocated) return MVKActivityPerformanceValueTypeByteCount;
+	if (&activity == &perfStats.device.gpuMemoryAllocated ||
+		&activity == &perfStats.device.hostMemoryPoolAllocated) return MVKActivityPerformanceValueTypeByteCount;
+	if (&activity == &perfStats.queue.submissionsBatched ||
+		&activity == &perfStats.queue.activeMTLCommandBuffers ||
+		&activity == &perfStats.device.hostMemoryPoolReuses ||
+		&activity == &perfStats.commandBuffer.redundantViewportsCompacted ||
+		&activity == &perfStats.commandBuffer.redundantScissorsCompacted ||
+		&activity == &perfStats.commandBuffer.redundantPipelineBindsCompacted ||
+		&activity == &perfStats.commandBuffer.pushConstantBytesUploaded ||
+		&activity == &perfStats.commandBuffer.copyRegionsCoalesced ||
+		&activity == &perfStats.commandBuffer.helperPipelineWarmupHits ||
+		&activity == &perfStats.commandBuffer.helperPipelineWarmupMisses) return MVKActivityPerformanceValueTypeCount;
 	return MVKActivityPerformanceValueTypeDuration;
 }
 
@@ -4817,6 +4926,36 @@ void MVKDevice::getPerformanceStatistics(MVKPerformanceStatistics* pPerf) {
     if (pPerf) { *pPerf = _performanceStats; }
 }
 
+// Groups the ranges by device memory, so each device memory can merge its ranges,
+// and visit the images bound to it, once for all of its ranges.
+VkResult MVKDevice::flushMappedMemoryRanges(uint32_t memRangeCount, const VkMappedMemoryRange* pMemRanges) {
+	if (memRangeCount == 1) {
+		return ((MVKDeviceMemory*)pMemRanges[0].memory)->flushToDevice(pMemRanges[0].offset, pMemRanges[0].size);
+	}
+
+	MVKSmallVector<const VkMappedMemoryRange*, 16> memRanges;
+	memRanges.reserve(memRangeCount);
+	for (uint32_t i = 0; i < memRangeCount; i++) { memRanges.push_back(&pMemRanges[i]); }
+	std::stable_sort(memRanges.data(), memRanges.data() + memRangeCount,
+					 [](const VkMappedMemoryRange* a, const VkMappedMemoryRange* b) { return a->memory < b->memory; });
+
+	VkResult rslt = VK_SUCCESS;
+	MVKSmallVector<MVKMappedMemoryRange, 16> mvkRanges;
+	for (uint32_t rngIdx = 0; rngIdx < memRangeCount; ) {
+		VkDeviceMemory vkMem = memRanges[rngIdx]->memory;
+		mvkRanges.clear();
+		for ( ; rngIdx < memRangeCount && memRanges[rngIdx]->memory == vkMem; rngIdx++) {
+			MVKMappedMemoryRange mvkRange;
+			mvkRange.offset = memRanges[rngIdx]->offset;
+			mvkRange.size = memRanges[rngIdx]->size;
+			mvkRanges.push_back(mvkRange);
+		}
+		VkResult r = ((MVKDeviceMemory*)vkMem)->flushToDevice(mvkRanges.contents());
+		if (rslt == VK_SUCCESS) { rslt = r; }
+	}
+	return rslt;
+}
+
 VkResult MVKDevice::invalidateMappedMemoryRanges(uint32_t memRangeCount, const VkMappedMemoryRange* pMemRanges) {
 	@autoreleasepool {
 		VkResult rslt = VK_SUCCESS;
@@ -5213,6 +5352,11 @@ MVKDevice::MVKDevice(MVKPhysicalDevice* physicalDevice, const VkDeviceCreateInfo
 																? "Metal argument buffers" : "Metal3 argument buffers") : "discrete resource indexes");
 
 	_commandResourceFactory = new MVKCommandResourceFactory(this);
+	_hostMemoryPool = new MVKHostMemoryPool(this);
+
+	if (getMVKConfig().deviceMemorySuballocationMaxSize && _physicalDevice->_metalFeatures.placementHeaps) {
+		_memorySuballocator = new MVKDeviceMemorySuballocator(this);
+	}
 
 	startAutoGPUCapture(MVK_CONFIG_AUTO_GPU_CAPTURE_SCOPE_DEVICE, _physicalDevice->_mtlDevice);
 
@@ -5581,6 +5725,8 @@ MVKDevice::~MVKDevice() {
 	}
 
 	if (_commandResourceFactory) { _commandResourceFactory->destroy(); }
+	if (_memorySuballocator) { _memorySuballocator->destroy(); }
+	if (_hostMemoryPool) { _hostMemoryPool->destroy(); }
 
 	for (auto &fences: _barrierFences) for (auto fence: fences) [fence release];
 
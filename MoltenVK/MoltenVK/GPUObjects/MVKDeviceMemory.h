@@ -33,6 +33,17 @@ typedef struct MVKMappedMemoryRange {
 	VkDeviceSize size = 0;
 } MVKMappedMemoryRange;
 
+/**
+ * The range of device memory bound to an image memory binding. MVKDeviceMemory keeps these sorted by offset,
+ * so it can find the image memory bindings that overlap a memory range without visiting every binding.
+ */
+typedef struct MVKImageMemoryBindingRange {
+	VkDeviceSize offset;
+	VkDeviceSize end;
+	VkDeviceSize maxEnd;				/**< The largest end of this range and all ranges before it. */
+	MVKImageMemoryBinding* binding;
+} MVKImageMemoryBindingRange;
+
 struct HeapAllocation {
     id<MTLHeap> heap = nil; // Reference to the heap containing this allocation
     size_t offset = 0; // Offset into the heap
@@ -99,6 +110,13 @@ public:
 	/** If this memory is host-visible, the specified memory range is flushed to the device. */
 	VkResult flushToDevice(VkDeviceSize offset, VkDeviceSize size);
 
+	/**
+	 * If this memory is host-visible, the specified memory ranges are flushed to the device.
+	 * Overlapping and adjacent ranges are merged, and each image bound to this memory is
+	 * flushed at most once per merged range. The contents of the ranges may be modified.
+	 */
+	VkResult flushToDevice(MVKArrayRef<MVKMappedMemoryRange> ranges);
+
 	/**
 	 * If this memory is host-visible, pulls the specified memory range from the device.
 	 *
@@ -122,6 +140,12 @@ public:
 	/** Returns the Metal heap underlying this memory allocation. */
 	id<MTLHeap> getMTLHeap() { return _mtlHeap; }
 
+	/**
+	 * Returns the offset of the start of this memory allocation within the Metal heap returned by getMTLHeap().
+	 * This is zero, unless this memory allocation has been carved out of a larger MTLHeap shared with other allocations.
+	 */
+	VkDeviceSize getMTLHeapOffset() { return _mtlHeapOffset; }
+
 	/** Returns the Metal storage mode used by this memory allocation. */
 	MTLStorageMode getMTLStorageMode() { return _mtlStorageMode; }
 
@@ -155,15 +179,23 @@ protected:
 	static void removeBuffer(MVKDeviceMemory** pMem, MVKBuffer* mvkBuf);
 	VkResult addImageMemoryBinding(MVKImageMemoryBinding* mvkImg);
 	static void removeImageMemoryBinding(MVKDeviceMemory** pMem, MVKImageMemoryBinding* mvkImg);
+	void indexImageMemoryBinding(MVKImageMemoryBinding* mvkImg);
+	void unindexImageMemoryBinding(MVKImageMemoryBinding* mvkImg);
+	void updateImageMemoryBindingMaxEnds(size_t startIdx);
+	template <typename F> void forEachImageMemoryBinding(VkDeviceSize offset, VkDeviceSize size, F func);
+	bool canUseMTLHeap();
 	bool ensureMTLHeap();
+	bool suballocateMTLHeap();
 	bool ensureMTLBuffer();
 	bool ensureHostMemory();
 	void freeHostMemory();
+	size_t getHostMemoryLength();
 	MVKResource* getDedicatedResource();
 	void initExternalMemory(MVKImage* dedicatedImage, bool wantsHeap);
 
 	MVKSmallVector<MVKBuffer*, 4> _buffers;
 	MVKSmallVector<MVKImageMemoryBinding*, 4> _imageMemoryBindings;
+	MVKSmallVector<MVKImageMemoryBindingRange, 4> _imageMemoryBindingRanges;
 	std::mutex _rezLock;
     VkDeviceSize _allocationSize = 0;
 	MVKMappedMemoryRange _mappedRange;
@@ -179,6 +211,8 @@ protected:
 	id<MTLHeap> _mtlHeap = nil;
 	void* _pMemory = nullptr;
 	void* _pHostMemory = nullptr;
+	VkDeviceSize _mtlHeapOffset = 0;
+	VkDeviceSize _mtlHeapSuballocationSize = 0;
 	VkMemoryPropertyFlags _vkMemPropFlags;
 	VkMemoryAllocateFlags _vkMemAllocFlags;
 	MTLStorageMode _mtlStorageMode;
@@ -188,3 +222,98 @@ protected:
 	VkExternalMemoryHandleTypeFlags _externalMemoryHandleType = 0u;
 };
 
+
+#pragma mark -
+#pragma mark MVKDeviceMemorySuballocator
+
+/**
+ * Carves small, non-dedicated VkDeviceMemory allocations out of larger shared MTLHeaps.
+ *
+ * Allocations are rounded up to a power-of-two size class. Each backing MTLHeap holds a fixed number of
+ * equally-sized slots of a single size class, so each slot is aligned to its size within the MTLHeap.
+ * Backing MTLHeaps are released once all of their slots are free, except for the last one in each size class.
+ */
+class MVKDeviceMemorySuballocator : public MVKBaseDeviceObject {
+
+public:
+
+	/** Returns the size of the slot that will hold an allocation of the specified size. */
+	VkDeviceSize getSlotSize(VkDeviceSize size);
+
+	/**
+	 * Reserves a slot that will hold an allocation of the specified size, in a MTLHeap with the specified
+	 * Metal storage and CPU cache modes. Returns the MTLHeap, and populates the offset of the slot within
+	 * the MTLHeap. The returned MTLHeap is not retained. Returns nil if a slot could not be reserved.
+	 */
+	id<MTLHeap> allocate(VkDeviceSize size, MTLStorageMode mtlStorageMode, MTLCPUCacheMode mtlCPUCacheMode, VkDeviceSize* pOffset);
+
+	/** Releases a slot of the specified size, previously reserved by allocate(). */
+	void free(id<MTLHeap> mtlHeap, VkDeviceSize offset, VkDeviceSize slotSize);
+
+	MVKDeviceMemorySuballocator(MVKDevice* device);
+
+	~MVKDeviceMemorySuballocator() override;
+
+protected:
+	typedef struct {
+		id<MTLHeap> mtlHeap;
+		uint64_t freeSlots;
+	} Slab;
+
+	typedef struct {
+		MVKSmallVector<Slab, 2> slabs;
+		VkDeviceSize slotSize;
+		uint32_t slotCount;
+		MTLStorageMode mtlStorageMode;
+		MTLCPUCacheMode mtlCPUCacheMode;
+	} SizeClass;
+
+	SizeClass& getSizeClass(VkDeviceSize slotSize, MTLStorageMode mtlStorageMode, MTLCPUCacheMode mtlCPUCacheMode);
+	id<MTLHeap> newMTLHeap(SizeClass& sizeClass);
+
+	MVKSmallVector<SizeClass*> _sizeClasses;
+	std::mutex _lock;
+};
+
+
+#pragma mark -
+#pragma mark MVKHostMemoryPool
+
+/**
+ * A pool of aligned blocks of host memory, used as the host-side backing of VkDeviceMemory allocations,
+ * so that allocations that are created and released every frame can reuse blocks instead of repeatedly
+ * returning them to the system allocator.
+ *
+ * Blocks are bucketed by size, rounded up to a power of two. The total size of idle blocks held by the
+ * pool is limited, and all idle blocks are returned to the system when the system reports memory pressure.
+ */
+class MVKHostMemoryPool : public MVKBaseDeviceObject {
+
+public:
+
+	/** Returns a block of host memory of at least the specified size, or null if memory could not be allocated. */
+	void* allocate(size_t size);
+
+	/** Returns a block of host memory, previously retrieved from allocate() with the same size, to this pool. */
+	void free(void* pMem, size_t size);
+
+	/** Returns all idle blocks of host memory to the system. */
+	void trim();
+
+	MVKHostMemoryPool(MVKDevice* device);
+
+	~MVKHostMemoryPool() override;
+
+protected:
+	uint32_t getBucketIndex(size_t size);
+	void freeIdleBlock(void* pMem, size_t blockSize);
+	void trackAllocatedSize();
+
+	MVKSmallVector<MVKSmallVector<void*, 4>> _idleBlocks;
+	std::mutex _lock;
+	dispatch_queue_t _memoryPressureQueue = nullptr;
+	dispatch_source_t _memoryPressureSource = nullptr;
+	size_t _alignment;
+	size_t _allocatedSize = 0;
+	size_t _idleSize = 0;
+};
@@ -32,7 +32,8 @@ using namespace std;
 #pragma mark MVKDeviceMemory
 
 void MVKDeviceMemory::propagateDebugName() {
-	setMetalObjectLabel(_mtlHeap, _debugName);
+	// Don't label a MTLHeap that is shared with other memory allocations.
+	if ( !_mtlHeapSuballocationSize ) { setMetalObjectLabel(_mtlHeap, _debugName); }
 	setMetalObjectLabel(_mtlBuffer, _debugName);
 }
 
@@ -81,19 +82,56 @@ VkResult MVKDeviceMemory::unmap(const VkMemoryUnmapInfo* pUnmapMemoryInfo) {
 }
 
 VkResult MVKDeviceMemory::flushToDevice(VkDeviceSize offset, VkDeviceSize size) {
-	VkDeviceSize memSize = adjustMemorySize(size, offset);
-	if (memSize == 0 || !isMemoryHostAccessible()) { return VK_SUCCESS; }
+	MVKMappedMemoryRange range;
+	range.offset = offset;
+	range.size = size;
+	return flushToDevice(MVKArrayRef<MVKMappedMemoryRange>(&range, 1));
+}
+
+// Sorts and merges the ranges in place, so each part of memory, and each image overlapping it, is flushed once.
+VkResult MVKDeviceMemory::flushToDevice(MVKArrayRef<MVKMappedMemoryRange> ranges) {
+	if ( !isMemoryHostAccessible() ) { return VK_SUCCESS; }
+
+	size_t rngCnt = 0;
+	for (auto& rng : ranges) {
+		VkDeviceSize memSize = adjustMemorySize(rng.size, rng.offset);
+		if (memSize) {
+			ranges[rngCnt].offset = rng.offset;
+			ranges[rngCnt].size = memSize;
+			rngCnt++;
+		}
+	}
+	if (rngCnt > 1) {
+		std::sort(ranges.begin(), ranges.begin() + rngCnt,
+				  [](const MVKMappedMemoryRange& a, const MVKMappedMemoryRange& b) { return a.offset < b.offset; });
+		size_t mrgCnt = 1;
+		for (size_t rngIdx = 1; rngIdx < rngCnt; rngIdx++) {
+			auto& prevRng = ranges[mrgCnt - 1];
+			auto& rng = ranges[rngIdx];
+			if (rng.offset <= prevRng.offset + prevRng.size) {
+				prevRng.size = std::max(prevRng.offset + prevRng.size, rng.offset + rng.size) - prevRng.offset;
+			} else {
+				ranges[mrgCnt++] = rng;
+			}
+		}
+		rngCnt = mrgCnt;
+	}
 
 #if MVK_MACOS
 	if ( !isUnifiedMemoryGPU() && _mtlBuffer && _mtlStorageMode == MTLStorageModeManaged) {
-		[_mtlBuffer didModifyRange: NSMakeRange(offset, memSize)];
+		for (size_t rngIdx = 0; rngIdx < rngCnt; rngIdx++) {
+			[_mtlBuffer didModifyRange: NSMakeRange(ranges[rngIdx].offset, ranges[rngIdx].size)];
+		}
 	}
 #endif
 
 	// If we have an MTLHeap object, there's no need to sync memory manually between resources and the buffer.
 	if ( !_mtlHeap ) {
 		lock_guard<mutex> lock(_rezLock);
-		for (auto& img : _imageMemoryBindings) { img->flushToDevice(offset, memSize); }
+		for (size_t rngIdx = 0; rngIdx < rngCnt; rngIdx++) {
+			auto& rng = ranges[rngIdx];
+			forEachImageMemoryBinding(rng.offset, rng.size, [&](MVKImageMemoryBinding* img) { img->flushToDevice(rng.offset, rng.size); });
+		}
 	}
 
 	return VK_SUCCESS;
@@ -116,7 +154,7 @@ VkResult MVKDeviceMemory::pullFromDevice(VkDeviceSize offset,
 	// If we have an MTLHeap object, there's no need to sync memory manually between resources and the buffer.
 	if ( !_mtlHeap ) {
 		lock_guard<mutex> lock(_rezLock);
-        for (auto& img : _imageMemoryBindings) { img->pullFromDevice(offset, memSize); }
+		forEachImageMemoryBinding(offset, memSize, [&](MVKImageMemoryBinding* img) { img->pullFromDevice(offset, memSize); });
 	}
 
 	return VK_SUCCESS;
@@ -172,7 +210,10 @@ VkResult MVKDeviceMemory::addImageMemoryBinding(MVKImageMemoryBinding* mvkImg) {
 		return reportError(VK_ERROR_OUT_OF_DEVICE_MEMORY, "Could not bind VkImage %p to a VkDeviceMemory dedicated to resource %p. A dedicated allocation may only be used with the resource it was dedicated to.", mvkImg, getDedicatedResource() );
 	}
 
-	if (!_isDedicated) { _imageMemoryBindings.push_back(mvkImg); }
+	if (!_isDedicated) {
+		_imageMemoryBindings.push_back(mvkImg);
+		indexImageMemoryBinding(mvkImg);
+	}
 
 	return VK_SUCCESS;
 }
@@ -183,10 +224,65 @@ void MVKDeviceMemory::removeImageMemoryBinding(MVKDeviceMemory** pMem, MVKImageM
 		*pMem = nullptr;
 		std::lock_guard<std::mutex> lock(mem->_rezLock);
 		mvkRemoveAllOccurances(mem->_imageMemoryBindings, mvkImg);
+		mem->unindexImageMemoryBinding(mvkImg);
 	}
 	os_unfair_lock_unlock(&s_device_memory_destruction_lock);
 }
 
+// Must be called while locked. Dedicated images are bound at the start of the memory.
+void MVKDeviceMemory::indexImageMemoryBinding(MVKImageMemoryBinding* mvkImg) {
+	MVKImageMemoryBindingRange imgRng;
+	imgRng.offset = _isDedicated ? 0 : mvkImg->getDeviceMemoryOffset();
+	imgRng.end = imgRng.offset + mvkImg->getByteCount();
+	imgRng.maxEnd = imgRng.end;
+	imgRng.binding = mvkImg;
+
+	auto* pRngs = _imageMemoryBindingRanges.data();
+	size_t rngIdx = std::upper_bound(pRngs, pRngs + _imageMemoryBindingRanges.size(), imgRng.offset,
+									 [](VkDeviceSize offset, const MVKImageMemoryBindingRange& rng) { return offset < rng.offset; }) - pRngs;
+	_imageMemoryBindingRanges.insert(_imageMemoryBindingRanges.begin() + rngIdx, imgRng);
+	updateImageMemoryBindingMaxEnds(rngIdx);
+}
+
+// Must be called while locked.
+void MVKDeviceMemory::unindexImageMemoryBinding(MVKImageMemoryBinding* mvkImg) {
+	size_t rngCnt = _imageMemoryBindingRanges.size();
+	for (size_t rngIdx = 0; rngIdx < rngCnt; rngIdx++) {
+		if (_imageMemoryBindingRanges[rngIdx].binding == mvkImg) {
+			_imageMemoryBindingRanges.erase(_imageMemoryBindingRanges.begin() + rngIdx);
+			updateImageMemoryBindingMaxEnds(rngIdx);
+			return;
+		}
+	}
+}
+
+// Must be called while locked. Updates the largest preceding end of each range, starting at the range at startIdx.
+void MVKDeviceMemory::updateImageMemoryBindingMaxEnds(size_t startIdx) {
+	VkDeviceSize maxEnd = startIdx ? _imageMemoryBindingRanges[startIdx - 1].maxEnd : 0;
+	size_t rngCnt = _imageMemoryBindingRanges.size();
+	for (size_t rngIdx = startIdx; rngIdx < rngCnt; rngIdx++) {
+		auto& rng = _imageMemoryBindingRanges[rngIdx];
+		maxEnd = std::max(maxEnd, rng.end);
+		rng.maxEnd = maxEnd;
+	}
+}
+
+// Must be called while locked. Calls func() with each image memory binding that overlaps the memory range.
+// Because the ranges are sorted by offset, and the largest preceding end never decreases, the first range
+// that might overlap is found by binary search, and the search stops at the first range that starts after
+// the end of the memory range.
+template <typename F>
+void MVKDeviceMemory::forEachImageMemoryBinding(VkDeviceSize offset, VkDeviceSize size, F func) {
+	VkDeviceSize end = offset + size;
+	auto* pRngs = _imageMemoryBindingRanges.data();
+	size_t rngCnt = _imageMemoryBindingRanges.size();
+	size_t rngIdx = std::partition_point(pRngs, pRngs + rngCnt,
+										 [offset](const MVKImageMemoryBindingRange& rng) { return rng.maxEnd <= offset; }) - pRngs;
+	for (; rngIdx < rngCnt && pRngs[rngIdx].offset < end; rngIdx++) {
+		if (pRngs[rngIdx].end > offset) { func(pRngs[rngIdx].binding); }
+	}
+}
+
 // Ensures that this instance is backed by a MTLHeap object,
 // creating the MTLHeap if needed, and returns whether it was successful.
 bool MVKDeviceMemory::ensureMTLHeap() {
@@ -199,23 +295,13 @@ bool MVKDeviceMemory::ensureMTLHeap() {
 	// Can't create a MTLHeap if we already have a _mtlBuffer
 	if (_mtlBuffer) { return true; }
 
-	// Don't bother if we don't have placement heaps.
-	if (!getMetalFeatures().placementHeaps) { return true; }
-
 	// Can't create MTLHeaps of zero size.
 	if (_allocationSize == 0) { return true; }
 
-#if !MVK_OS_SIMULATOR
-	if (getPhysicalDevice()->getMTLDeviceCapabilities().isAppleGPU) {
-		// MTLHeaps on Apple silicon must use private or shared storage for now.
-		if ( !(_mtlStorageMode == MTLStorageModePrivate ||
-		       _mtlStorageMode == MTLStorageModeShared) ) { return true; }
-	} else
-#endif
-	{
-		// MTLHeaps with immediate-mode GPUs must use private storage for now.
-		if (_mtlStorageMode != MTLStorageModePrivate) { return true; }
-	}
+	if ( !canUseMTLHeap() ) { return true; }
+
+	// Small allocations may be carved out of a larger MTLHeap shared with other allocations.
+	if (suballocateMTLHeap()) { return true; }
 
 	MTLHeapDescriptor* heapDesc = [MTLHeapDescriptor new];
 	heapDesc.type = MTLHeapTypePlacement;
@@ -234,6 +320,39 @@ bool MVKDeviceMemory::ensureMTLHeap() {
 	return true;
 }
 
+// Returns whether the storage mode of this memory can be used by a MTLHeap.
+bool MVKDeviceMemory::canUseMTLHeap() {
+
+	// Don't bother if we don't have placement heaps.
+	if (!getMetalFeatures().placementHeaps) { return false; }
+
+#if !MVK_OS_SIMULATOR
+	if (getPhysicalDevice()->getMTLDeviceCapabilities().isAppleGPU) {
+		// MTLHeaps on Apple silicon must use private or shared storage for now.
+		return (_mtlStorageMode == MTLStorageModePrivate ||
+				_mtlStorageMode == MTLStorageModeShared);
+	}
+#endif
+	// MTLHeaps with immediate-mode GPUs must use private storage for now.
+	return _mtlStorageMode == MTLStorageModePrivate;
+}
+
+// If suballocation is enabled, and this is a small non-dedicated allocation that won't be exported,
+// reserves a slot in a larger MTLHeap shared with other allocations, and returns whether it was successful.
+bool MVKDeviceMemory::suballocateMTLHeap() {
+	auto* subAllocator = _device->getMemorySuballocator();
+	if ( !subAllocator || _isDedicated || _externalMemoryHandleType ) { return false; }
+	if (_allocationSize > getMVKConfig().deviceMemorySuballocationMaxSize) { return false; }
+
+	id<MTLHeap> mtlHeap = subAllocator->allocate(_allocationSize, _mtlStorageMode, _mtlCPUCacheMode, &_mtlHeapOffset);
+	if ( !mtlHeap ) { return false; }
+
+	_mtlHeap = [mtlHeap retain];		// retained
+	_mtlHeapSuballocationSize = subAllocator->getSlotSize(_allocationSize);
+
+	return true;
+}
+
 // Ensures that this instance is backed by a MTLBuffer object,
 // creating the MTLBuffer if needed, and returns whether it was successful.
 bool MVKDeviceMemory::ensureMTLBuffer() {
@@ -247,7 +366,7 @@ bool MVKDeviceMemory::ensureMTLBuffer() {
 	id<MTLBuffer> buf;
 	// If host memory was already allocated, it is copied into the new MTLBuffer, and then released.
 	if (_mtlHeap) {
-		buf = [_mtlHeap newBufferWithLength: memLen options: getMTLResourceOptions() offset: 0];	// retained
+		buf = [_mtlHeap newBufferWithLength: memLen options: getMTLResourceOptions() offset: _mtlHeapOffset];	// retained
 		if (_pHostMemory) {
 			memcpy(buf.contents, _pHostMemory, memLen);
 			freeHostMemory();
@@ -281,10 +400,8 @@ bool MVKDeviceMemory::ensureHostMemory() {
 	if (_pMemory) { return true; }
 
 	if ( !_pHostMemory) {
-		size_t memAlign = getMetalFeatures().mtlBufferAlignment;
-		NSUInteger memLen = mvkAlignByteCount(_allocationSize, memAlign);
-		int err = posix_memalign(&_pHostMemory, memAlign, memLen);
-		if (err) { return false; }
+		_pHostMemory = _device->getHostMemoryPool()->allocate(getHostMemoryLength());
+		if ( !_pHostMemory ) { return false; }
 	}
 
 	_pMemory = _pHostMemory;
@@ -292,11 +409,16 @@ bool MVKDeviceMemory::ensureHostMemory() {
 	return true;
 }
 
+// Host memory is returned to the device pool, so it can be reused by another allocation.
 void MVKDeviceMemory::freeHostMemory() {
-	if ( !_isHostMemImported ) { free(_pHostMemory); }
+	if ( !_isHostMemImported ) { _device->getHostMemoryPool()->free(_pHostMemory, getHostMemoryLength()); }
 	_pHostMemory = nullptr;
 }
 
+size_t MVKDeviceMemory::getHostMemoryLength() {
+	return mvkAlignByteCount(_allocationSize, getMetalFeatures().mtlBufferAlignment);
+}
+
 MVKResource* MVKDeviceMemory::getDedicatedResource() {
 	MVKAssert(_isDedicated, "This method should only be called on dedicated allocations!");
 	return _buffers.empty() ? (MVKResource*)_imageMemoryBindings[0] : (MVKResource*)_buffers[0];
@@ -424,6 +546,7 @@ MVKDeviceMemory::MVKDeviceMemory(MVKDevice* device,
 		}
         for (auto& memoryBinding : dedicatedImage->_memoryBindings) {
             _imageMemoryBindings.push_back(memoryBinding);
+            indexImageMemoryBinding(memoryBinding);
         }
 		return;
 	}
@@ -518,8 +641,240 @@ MVKDeviceMemory::~MVKDeviceMemory() {
 		[buf release];
 	}
 
+	if (_mtlHeapSuballocationSize) {
+		_device->getMemorySuballocator()->free(_mtlHeap, _mtlHeapOffset, _mtlHeapSuballocationSize);
+	}
 	[_mtlHeap release];
 	_mtlHeap = nil;
 
 	freeHostMemory();
 }
+
+
+#pragma mark -
+#pragma mark MVKDeviceMemorySuballocator
+
+// The smallest slot size. Keeping slots at least this large keeps each slot aligned
+// well enough for any buffer or texture that Metal will place within a MTLHeap.
+static constexpr VkDeviceSize kMVKDeviceMemorySuballocationMinSlotSize = 64 * KIBI;
+
+// The limit on the number of slots each backing MTLHeap holds. The preferred size of each
+// backing MTLHeap, and the minimum number of slots it holds, are in MVKEnvironment.h.
+static constexpr uint32_t kMVKDeviceMemorySuballocationMaxSlotCount = 64;
+
+static uint64_t getAllSlotsMask(uint32_t slotCount) {
+	return slotCount >= 64 ? ~0ULL : (1ULL << slotCount) - 1;
+}
+
+VkDeviceSize MVKDeviceMemorySuballocator::getSlotSize(VkDeviceSize size) {
+	return mvkEnsurePowerOfTwo(std::max(size, kMVKDeviceMemorySuballocationMinSlotSize));
+}
+
+id<MTLHeap> MVKDeviceMemorySuballocator::allocate(VkDeviceSize size,
+												  MTLStorageMode mtlStorageMode,
+												  MTLCPUCacheMode mtlCPUCacheMode,
+												  VkDeviceSize* pOffset) {
+	lock_guard<mutex> lock(_lock);
+
+	auto& sizeClass = getSizeClass(getSlotSize(size), mtlStorageMode, mtlCPUCacheMode);
+
+	Slab* pSlab = nullptr;
+	for (auto& slab : sizeClass.slabs) {
+		if (slab.freeSlots) { pSlab = &slab; break; }
+	}
+	if ( !pSlab ) {
+		id<MTLHeap> mtlHeap = newMTLHeap(sizeClass);
+		if ( !mtlHeap ) { return nil; }
+		sizeClass.slabs.push_back({ mtlHeap, getAllSlotsMask(sizeClass.slotCount) });
+		pSlab = &sizeClass.slabs.back();
+	}
+
+	uint32_t slotIdx = __builtin_ctzll(pSlab->freeSlots);
+	mvkDisableFlags(pSlab->freeSlots, 1ULL << slotIdx);
+	*pOffset = slotIdx * sizeClass.slotSize;
+
+	return pSlab->mtlHeap;
+}
+
+// Once a backing MTLHeap is empty, it is released, unless it is the last one in
+// its size class, which is kept to avoid churn when allocations come and go.
+void MVKDeviceMemorySuballocator::free(id<MTLHeap> mtlHeap, VkDeviceSize offset, VkDeviceSize slotSize) {
+	lock_guard<mutex> lock(_lock);
+
+	auto& sizeClass = getSizeClass(slotSize, mtlHeap.storageMode, mtlHeap.cpuCacheMode);
+	size_t slabCnt = sizeClass.slabs.size();
+	for (size_t slabIdx = 0; slabIdx < slabCnt; slabIdx++) {
+		auto& slab = sizeClass.slabs[slabIdx];
+		if (slab.mtlHeap != mtlHeap) { continue; }
+
+		mvkEnableFlags(slab.freeSlots, 1ULL << (offset / slotSize));
+		if (slab.freeSlots == getAllSlotsMask(sizeClass.slotCount) && slabCnt > 1) {
+			[slab.mtlHeap release];
+			sizeClass.slabs.erase(sizeClass.slabs.begin() + slabIdx);
+		}
+		return;
+	}
+}
+
+MVKDeviceMemorySuballocator::SizeClass& MVKDeviceMemorySuballocator::getSizeClass(VkDeviceSize slotSize,
+																				  MTLStorageMode mtlStorageMode,
+																				  MTLCPUCacheMode mtlCPUCacheMode) {
+	for (auto* pSizeClass : _sizeClasses) {
+		if (pSizeClass->slotSize == slotSize &&
+			pSizeClass->mtlStorageMode == mtlStorageMode &&
+			pSizeClass->mtlCPUCacheMode == mtlCPUCacheMode) { return *pSizeClass; }
+	}
+
+	auto* pSizeClass = new SizeClass();
+	pSizeClass->slotSize = slotSize;
+	pSizeClass->slotCount = (uint32_t)std::clamp<VkDeviceSize>(kMVKDeviceMemorySuballocationSlabSize / slotSize,
+															   kMVKDeviceMemorySuballocationMinSlotCount,
+															   kMVKDeviceMemorySuballocationMaxSlotCount);
+	pSizeClass->mtlStorageMode = mtlStorageMode;
+	pSizeClass->mtlCPUCacheMode = mtlCPUCacheMode;
+	_sizeClasses.push_back(pSizeClass);
+	return *pSizeClass;
+}
+
+// Returns a new backing MTLHeap, configured the same way as the MTLHeap of a standalone memory allocation.
+id<MTLHeap> MVKDeviceMemorySuballocator::newMTLHeap(SizeClass& sizeClass) {
+	MTLHeapDescriptor* heapDesc = [MTLHeapDescriptor new];
+	heapDesc.type = MTLHeapTypePlacement;
+	heapDesc.storageMode = sizeClass.mtlStorageMode;
+	heapDesc.cpuCacheMode = sizeClass.mtlCPUCacheMode;
+	heapDesc.hazardTrackingMode = MTLHazardTrackingModeTracked;
+	heapDesc.size = sizeClass.slotSize * sizeClass.slotCount;
+	id<MTLHeap> mtlHeap = [getMTLDevice() newHeapWithDescriptor: heapDesc];	// retained
+	[heapDesc release];
+	return mtlHeap;
+}
+
+MVKDeviceMemorySuballocator::MVKDeviceMemorySuballocator(MVKDevice* device) : MVKBaseDeviceObject(device) {}
+
+MVKDeviceMemorySuballocator::~MVKDeviceMemorySuballocator() {
+	for (auto* pSizeClass : _sizeClasses) {
+		for (auto& slab : pSizeClass->slabs) { [slab.mtlHeap release]; }
+		delete pSizeClass;
+	}
+}
+
+
+#pragma mark -
+#pragma mark MVKHostMemoryPool
+
+// Blocks smaller than the smallest bucket are cheap for the system allocator to provide,
+// and blocks larger than the largest bucket are too large to hold idle, so neither is pooled.
+static constexpr uint32_t kMVKHostMemoryPoolMinBlockSizeExponent = 16;		// 64 KB
+static constexpr uint32_t kMVKHostMemoryPoolMaxBlockSizeExponent = 28;		// 256 MB
+static constexpr uint32_t kMVKHostMemoryPoolBucketCount = kMVKHostMemoryPoolMaxBlockSizeExponent - kMVKHostMemoryPoolMinBlockSizeExponent + 1;
+static constexpr uint32_t kMVKHostMemoryPoolNoBucket = kMVKHostMemoryPoolBucketCount;
+
+// The maximum total size of the idle blocks held by the pool.
+static constexpr size_t kMVKHostMemoryPoolMaxIdleSize = 256 * MEBI;
+
+void* MVKHostMemoryPool::allocate(size_t size) {
+	void* pMem = nullptr;
+	uint32_t bktIdx = getBucketIndex(size);
+	if (bktIdx == kMVKHostMemoryPoolNoBucket) {
+		return posix_memalign(&pMem, _alignment, size) ? nullptr : pMem;
+	}
+
+	size_t blockSize = size_t(1) << (bktIdx + kMVKHostMemoryPoolMinBlockSizeExponent);
+	lock_guard<mutex> lock(_lock);
+
+	auto& idleBlocks = _idleBlocks[bktIdx];
+	if ( !idleBlocks.empty() ) {
+		pMem = idleBlocks.back();
+		idleBlocks.pop_back();
+		_idleSize -= blockSize;
+		addPerformanceCount(getPerformanceStats().device.hostMemoryPoolReuses, 1);
+		return pMem;
+	}
+
+	if (posix_memalign(&pMem, _alignment, blockSize)) { return nullptr; }
+	_allocatedSize += blockSize;
+	trackAllocatedSize();
+	return pMem;
+}
+
+// Holds the block idle for reuse, unless that would exceed the limit on the size of idle blocks.
+void MVKHostMemoryPool::free(void* pMem, size_t size) {
+	if ( !pMem ) { return; }
+
+	uint32_t bktIdx = getBucketIndex(size);
+	if (bktIdx == kMVKHostMemoryPoolNoBucket) {
+		::free(pMem);
+		return;
+	}
+
+	size_t blockSize = size_t(1) << (bktIdx + kMVKHostMemoryPoolMinBlockSizeExponent);
+	lock_guard<mutex> lock(_lock);
+
+	if (_idleSize + blockSize <= kMVKHostMemoryPoolMaxIdleSize) {
+		_idleBlocks[bktIdx].push_back(pMem);
+		_idleSize += blockSize;
+	} else {
+		freeIdleBlock(pMem, blockSize);
+		trackAllocatedSize();
+	}
+}
+
+void MVKHostMemoryPool::trim() {
+	lock_guard<mutex> lock(_lock);
+
+	if ( !_idleSize ) { return; }
+
+	for (uint32_t bktIdx = 0; bktIdx < kMVKHostMemoryPoolBucketCount; bktIdx++) {
+		size_t blockSize = size_t(1) << (bktIdx + kMVKHostMemoryPoolMinBlockSizeExponent);
+		for (void* pMem : _idleBlocks[bktIdx]) { freeIdleBlock(pMem, blockSize); }
+		_idleBlocks[bktIdx].clear();
+	}
+	_idleSize = 0;
+	trackAllocatedSize();
+}
+
+uint32_t MVKHostMemoryPool::getBucketIndex(size_t size) {
+	uint32_t sizeExp = (uint32_t)mvkPowerOfTwoExponent(size);
+	if (sizeExp < kMVKHostMemoryPoolMinBlockSizeExponent || sizeExp > kMVKHostMemoryPoolMaxBlockSizeExponent) {
+		return kMVKHostMemoryPoolNoBucket;
+	}
+	return sizeExp - kMVKHostMemoryPoolMinBlockSizeExponent;
+}
+
+void MVKHostMemoryPool::freeIdleBlock(void* pMem, size_t blockSize) {
+	::free(pMem);
+	_allocatedSize -= blockSize;
+}
+
+// Tracking the size after each change lets the maximum of the tracker record the high-water mark.
+void MVKHostMemoryPool::trackAllocatedSize() {
+	addPerformanceCount(getPerformanceStats().device.hostMemoryPoolAllocated, _allocatedSize / KIBI);
+}
+
+MVKHostMemoryPool::MVKHostMemoryPool(MVKDevice* device) : MVKBaseDeviceObject(device) {
+	_alignment = std::max<size_t>(getMetalFeatures().mtlBufferAlignment, sizeof(void*));
+	_idleBlocks.resize(kMVKHostMemoryPoolBucketCount);
+
+	// Return idle blocks to the system when the system is running low on memory.
+	_memoryPressureQueue = dispatch_queue_create("com.moltenvk.host-memory-pool", DISPATCH_QUEUE_SERIAL);
+	_memoryPressureSource = dispatch_source_create(DISPATCH_SOURCE_TYPE_MEMORYPRESSURE, 0,
+												   DISPATCH_MEMORYPRESSURE_WARN | DISPATCH_MEMORYPRESSURE_CRITICAL,
+												   _memoryPressureQueue);
+	if (_memoryPressureSource) {
+		dispatch_source_set_event_handler(_memoryPressureSource, ^{ trim(); });
+		dispatch_resume(_memoryPressureSource);
+	}
+}
+
+MVKHostMemoryPool::~MVKHostMemoryPool() {
+	// Once cancelled, the source handler won't start again, and syncing
+	// on its serial queue waits for any handler that is already running.
+	if (_memoryPressureSource) {
+		dispatch_source_cancel(_memoryPressureSource);
+		dispatch_sync(_memoryPressureQueue, ^{});
+		dispatch_release(_memoryPressureSource);
+	}
+	dispatch_release(_memoryPressureQueue);
+
+	trim();
+}
@@ -45,6 +45,31 @@ typedef struct {
     VkImageLayout layoutState;
 } MVKImageSubresource;
 
+/** A region of an image subresource, and the offset of its content from the start of the subresource layout. */
+typedef struct {
+	MTLRegion mtlRegion;
+	VkDeviceSize byteOffset;
+} MVKImageSubresourceRegion;
+
+/** The maximum number of regions returned by mvkGetImageSubresourceRegions(). */
+static constexpr uint32_t kMVKMaxImageSubresourceRegionCount = 3;
+
+/**
+ * Populates pRegions with the minimal set of regions, each made of whole rows of texel blocks, that cover
+ * the bytes in the range [offset, offset + size) of an image subresource with the specified layout and extent,
+ * where offset is relative to the start of the subresource layout. Returns the number of regions populated,
+ * which is at most kMVKMaxImageSubresourceRegionCount, or zero if the range does not cover any texel content.
+ *
+ * If the layout does not describe rows of blocks packed within slices, a single region covering
+ * the entire subresource is returned for any range that overlaps the layout.
+ */
+uint32_t mvkGetImageSubresourceRegions(const VkSubresourceLayout& layout,
+									   VkExtent3D mipExtent,
+									   uint32_t blockHeight,
+									   VkDeviceSize offset,
+									   VkDeviceSize size,
+									   MVKImageSubresourceRegion* pRegions);
+
 class MVKImagePlane : public MVKBaseObject {
 
 public:
@@ -68,11 +93,16 @@ protected:
 	friend class MVKImageViewPlane;
 
     MTLTextureDescriptor* newMTLTextureDescriptor();
+    bool usesHeapTextureLayout();
     void initSubresources(const VkImageCreateInfo* pCreateInfo);
     MVKImageSubresource* getSubresource(uint32_t mipLevel, uint32_t arrayLayer);
     void updateMTLTextureContent(MVKImageSubresource& subresource, VkDeviceSize offset, VkDeviceSize size);
     void getMTLTextureContent(MVKImageSubresource& subresource, VkDeviceSize offset, VkDeviceSize size);
 	bool overlaps(VkSubresourceLayout& imgLayout, VkDeviceSize offset, VkDeviceSize size);
+	uint32_t getOverlappingRegions(MVKImageSubresource& subresource,
+								   VkDeviceSize offset,
+								   VkDeviceSize size,
+								   MVKImageSubresourceRegion* pRegions);
     void propagateDebugName();
     MVKImageMemoryBinding* getMemoryBinding() const;
 	void applyImageMemoryBarrier(MVKPipelineBarrier& barrier,
@@ -486,6 +516,9 @@ public:
 						 const MVKSwapchainSignaler& signaler,
 						 uint64_t actualPresentTime = 0);
 
+	/** Called when the presentation could not be submitted to the GPU, and so will never complete. */
+	void abandonPresentation(const MVKImagePresentInfo& presentInfo);
+
 #pragma mark Construction
 
 	MVKPresentableSwapchainImage(MVKDevice* device, const VkImageCreateInfo* pCreateInfo,
@@ -499,6 +532,7 @@ protected:
 	friend MVKSwapchain;
 
 	id<CAMetalDrawable> getCAMetalDrawable();
+	VkResult presentHeadless(id<MTLCommandBuffer> mtlCmdBuff, MVKImagePresentInfo presentInfo);
 	void addPresentedHandler(id<CAMetalDrawable> mtlDrawable, MVKImagePresentInfo presentInfo, MVKSwapchainSignaler signaler);
 	void releaseMetalDrawable();
 	MVKSwapchainImageAvailability getAvailability();
@@ -94,7 +94,7 @@ id<MTLTexture> MVKImagePlane::getMTLTexture() {
         } else if (dvcMem && dvcMem->getMTLHeap() && !_image->getIsDepthStencil()) {
             // Metal support for depth/stencil from heaps is flaky
             _heapAllocation.heap = dvcMem->getMTLHeap();
-            _heapAllocation.offset = memoryBinding->getDeviceMemoryOffset() + _subresources[0].layout.offset;
+            _heapAllocation.offset = dvcMem->getMTLHeapOffset() + memoryBinding->getDeviceMemoryOffset() + _subresources[0].layout.offset;
             const auto texSizeAlign = [dvcMem->getMTLDevice() heapTextureSizeAndAlignWithDescriptor:mtlTexDesc];
             _heapAllocation.size = texSizeAlign.size;
             _heapAllocation.align = texSizeAlign.align;
@@ -197,7 +197,7 @@ void MVKImagePlane::initSubresources(const VkImageCreateInfo* pCreateInfo) {
     // Calculation method depends on whether the resource is optimally tiled in a heap or not.
     // Note: vkGetImageSubresourceLayout is not allowed for optimal tiling, and vkGetImageSubresourceLayout2 is undefined.
     // However, this information is still needed for other uses within MoltenVK, such as texture memory aliasing.
-    if (!_image->_isLinear && !_image->_isLinearForAtomics && _image->getMetalFeatures().placementHeaps) {
+    if (usesHeapTextureLayout()) {
         MTLTextureDescriptor* mtlTexDesc = newMTLTextureDescriptor(); // temp retain
 
         if (_planeIndex > 0 && _image->getMemoryBindingCount() == 1) {
@@ -301,8 +301,8 @@ MVKImageSubresource* MVKImagePlane::getSubresource(uint32_t mipLevel, uint32_t a
     return (srIdx < _subresources.size()) ? &_subresources[srIdx] : nullptr;
 }
 
-// Updates the contents of the underlying MTLTexture, corresponding to the
-// specified subresource definition, from the underlying memory buffer.
+// Updates the contents of the underlying MTLTexture, corresponding to the specified subresource
+// definition, from the underlying memory buffer. Only the rows covered by the memory range are updated.
 void MVKImagePlane::updateMTLTextureContent(MVKImageSubresource& subresource,
                                             VkDeviceSize offset, VkDeviceSize size) {
 
@@ -316,12 +316,7 @@ void MVKImagePlane::updateMTLTextureContent(MVKImageSubresource& subresource,
     void* pHostMem = getMemoryBinding()->getHostMemoryAddress();
     if ( !pHostMem ) { return; }
 
-    VkExtent3D mipExtent = _image->getExtent3D(_planeIndex, imgSubRez.mipLevel);
-    void* pImgBytes = (void*)((uintptr_t)pHostMem + imgLayout.offset);
-
-    MTLRegion mtlRegion;
-    mtlRegion.origin = MTLOriginMake(0, 0, 0);
-    mtlRegion.size = mvkMTLSizeFromVkExtent3D(mipExtent);
+    uintptr_t imgBytes = (uintptr_t)pHostMem + imgLayout.offset;
 
     VkImageType imgType = _image->getImageType();
     VkDeviceSize bytesPerRow = (imgType != VK_IMAGE_TYPE_1D) ? imgLayout.rowPitch : 0;
@@ -333,16 +328,20 @@ void MVKImagePlane::updateMTLTextureContent(MVKImageSubresource& subresource,
         bytesPerImage = 0;
     }
 
-    [mtlTex replaceRegion: mtlRegion
-              mipmapLevel: imgSubRez.mipLevel
-                    slice: imgSubRez.arrayLayer
-                withBytes: pImgBytes
-              bytesPerRow: bytesPerRow
-            bytesPerImage: bytesPerImage];
+	MVKImageSubresourceRegion regions[kMVKMaxImageSubresourceRegionCount];
+	uint32_t regionCount = getOverlappingRegions(subresource, offset, size, regions);
+	for (uint32_t rgnIdx = 0; rgnIdx < regionCount; rgnIdx++) {
+		[mtlTex replaceRegion: regions[rgnIdx].mtlRegion
+				  mipmapLevel: imgSubRez.mipLevel
+						slice: imgSubRez.arrayLayer
+					withBytes: (void*)(imgBytes + regions[rgnIdx].byteOffset)
+				  bytesPerRow: bytesPerRow
+				bytesPerImage: bytesPerImage];
+	}
 }
 
-// Updates the contents of the underlying memory buffer from the contents of
-// the underlying MTLTexture, corresponding to the specified subresource definition.
+// Updates the contents of the underlying memory buffer from the contents of the underlying MTLTexture,
+// corresponding to the specified subresource definition. Only the rows covered by the memory range are read.
 void MVKImagePlane::getMTLTextureContent(MVKImageSubresource& subresource,
                                          VkDeviceSize offset, VkDeviceSize size) {
 
@@ -356,23 +355,111 @@ void MVKImagePlane::getMTLTextureContent(MVKImageSubresource& subresource,
     void* pHostMem = getMemoryBinding()->getHostMemoryAddress();
     if ( !pHostMem ) { return; }
 
-    VkExtent3D mipExtent = _image->getExtent3D(_planeIndex, imgSubRez.mipLevel);
-    void* pImgBytes = (void*)((uintptr_t)pHostMem + imgLayout.offset);
-
-    MTLRegion mtlRegion;
-    mtlRegion.origin = MTLOriginMake(0, 0, 0);
-    mtlRegion.size = mvkMTLSizeFromVkExtent3D(mipExtent);
+    uintptr_t imgBytes = (uintptr_t)pHostMem + imgLayout.offset;
 
     VkImageType imgType = _image->getImageType();
     VkDeviceSize bytesPerRow = (imgType != VK_IMAGE_TYPE_1D) ? imgLayout.rowPitch : 0;
     VkDeviceSize bytesPerImage = (imgType == VK_IMAGE_TYPE_3D) ? imgLayout.depthPitch : 0;
 
-    [_mtlTexture getBytes: pImgBytes
-              bytesPerRow: bytesPerRow
-            bytesPerImage: bytesPerImage
-               fromRegion: mtlRegion
-              mipmapLevel: imgSubRez.mipLevel
-                    slice: imgSubRez.arrayLayer];
+	MVKImageSubresourceRegion regions[kMVKMaxImageSubresourceRegionCount];
+	uint32_t regionCount = getOverlappingRegions(subresource, offset, size, regions);
+	for (uint32_t rgnIdx = 0; rgnIdx < regionCount; rgnIdx++) {
+		[_mtlTexture getBytes: (void*)(imgBytes + regions[rgnIdx].byteOffset)
+				  bytesPerRow: bytesPerRow
+				bytesPerImage: bytesPerImage
+				   fromRegion: regions[rgnIdx].mtlRegion
+				  mipmapLevel: imgSubRez.mipLevel
+						slice: imgSubRez.arrayLayer];
+	}
+}
+
+// Returns whether the subresource layouts of this plane are derived from the size of the texture in a placement
+// heap, in which case the row pitch of each layout is the layout size divided by the texel rows, not block rows.
+bool MVKImagePlane::usesHeapTextureLayout() {
+	return !_image->_isLinear && !_image->_isLinearForAtomics && _image->getMetalFeatures().placementHeaps;
+}
+
+// Populates pRegions with the regions of the subresource covered by the memory range, and returns the
+// number of regions. PVRTC textures can only be updated as a whole, so they always use a single region.
+// Layouts derived from a placement heap texture size do not describe rows of texel blocks, so textures
+// using them are also updated as a whole.
+uint32_t MVKImagePlane::getOverlappingRegions(MVKImageSubresource& subresource,
+											  VkDeviceSize offset,
+											  VkDeviceSize size,
+											  MVKImageSubresourceRegion* pRegions) {
+	VkSubresourceLayout& imgLayout = subresource.layout;
+	VkExtent3D mipExtent = _image->getExtent3D(_planeIndex, subresource.subresource.mipLevel);
+	if (_image->getPixelFormats()->isPVRTCFormat(_mtlPixFmt) || usesHeapTextureLayout()) {
+		pRegions[0].mtlRegion = MTLRegionMake3D(0, 0, 0, mipExtent.width, mipExtent.height, mipExtent.depth);
+		pRegions[0].byteOffset = 0;
+		return 1;
+	}
+
+	// Convert the memory range to a range relative to the start of the subresource.
+	VkDeviceSize imgStart = getMemoryBinding()->_deviceMemoryOffset + imgLayout.offset;
+	VkDeviceSize rezOffset = (offset > imgStart) ? offset - imgStart : 0;
+	VkDeviceSize rezSize = (offset > imgStart) ? size : size - std::min(size, imgStart - offset);
+	uint32_t blockHeight = _image->getPixelFormats()->getBlockTexelSize(_mtlPixFmt).height;
+	return mvkGetImageSubresourceRegions(imgLayout, mipExtent, blockHeight, rezOffset, rezSize, pRegions);
+}
+
+// Rows are the unit of transfer, because the bytes of a row are contiguous. The covered range is split into
+// a partial first slice, a run of whole slices, and a partial last slice, merging adjacent parts when possible.
+uint32_t mvkGetImageSubresourceRegions(const VkSubresourceLayout& layout,
+									   VkExtent3D mipExtent,
+									   uint32_t blockHeight,
+									   VkDeviceSize offset,
+									   VkDeviceSize size,
+									   MVKImageSubresourceRegion* pRegions) {
+	if (offset >= layout.size || !size || !mipExtent.width || !mipExtent.height || !mipExtent.depth) { return 0; }
+
+	blockHeight = std::max(blockHeight, 1u);
+	VkDeviceSize rowPitch = layout.rowPitch;
+	VkDeviceSize depthPitch = layout.depthPitch;
+	uint32_t rowCount = (uint32_t)mvkCeilingDivide(mipExtent.height, blockHeight);
+	uint32_t sliceCount = mipExtent.depth;
+	if ( !rowPitch || depthPitch < rowPitch * rowCount || layout.size < depthPitch * sliceCount) {
+		pRegions[0].mtlRegion = MTLRegionMake3D(0, 0, 0, mipExtent.width, mipExtent.height, mipExtent.depth);
+		pRegions[0].byteOffset = 0;
+		return 1;
+	}
+
+	// Locate the rows holding the first and last bytes of the range, skipping any padding after the rows of a slice.
+	VkDeviceSize lastByte = offset + std::min(size, layout.size - offset) - 1;
+	uint32_t firstSlice = (uint32_t)(offset / depthPitch);
+	uint32_t firstRow = (uint32_t)((offset % depthPitch) / rowPitch);
+	if (firstRow >= rowCount) { firstSlice++; firstRow = 0; }
+	uint32_t lastSlice = (uint32_t)(lastByte / depthPitch);
+	uint32_t lastRow = (uint32_t)((lastByte % depthPitch) / rowPitch);
+	if (lastRow >= rowCount) { lastRow = rowCount - 1; }
+	if (lastSlice >= sliceCount) { lastSlice = sliceCount - 1; lastRow = rowCount - 1; }
+	if (firstSlice > lastSlice || (firstSlice == lastSlice && firstRow > lastRow)) { return 0; }
+
+	uint32_t rgnCnt = 0;
+	auto addRegion = [&](uint32_t slice, uint32_t sliceCnt, uint32_t row, uint32_t rowEnd) {
+		uint32_t y = row * blockHeight;
+		uint32_t yEnd = std::min(rowEnd * blockHeight, mipExtent.height);
+		pRegions[rgnCnt].mtlRegion = MTLRegionMake3D(0, y, slice, mipExtent.width, yEnd - y, sliceCnt);
+		pRegions[rgnCnt].byteOffset = (slice * depthPitch) + (row * rowPitch);
+		rgnCnt++;
+	};
+
+	if (firstSlice == lastSlice) {
+		addRegion(firstSlice, 1, firstRow, lastRow + 1);
+		return rgnCnt;
+	}
+
+	uint32_t wholeSliceStart = firstSlice + 1;
+	uint32_t wholeSliceEnd = lastSlice;
+	if (firstRow == 0) {
+		wholeSliceStart = firstSlice;
+	} else {
+		addRegion(firstSlice, 1, firstRow, rowCount);
+	}
+	if (lastRow == rowCount - 1) { wholeSliceEnd = lastSlice + 1; }
+	if (wholeSliceEnd > wholeSliceStart) { addRegion(wholeSliceStart, wholeSliceEnd - wholeSliceStart, 0, rowCount); }
+	if (lastRow != rowCount - 1) { addRegion(lastSlice, 1, 0, lastRow + 1); }
+	return rgnCnt;
 }
 
 // Returns whether subresource layout overlaps the memory range.
@@ -511,7 +598,7 @@ VkResult MVKImageMemoryBinding::bindDeviceMemory(MVKDeviceMemory* mvkMem, VkDevi
             // Create our own buffer for this.
             if (_ownsTexelBuffer) { [_mtlTexelBuffer release]; }
             if (_deviceMemory->_mtlHeap && _image->getMTLStorageMode() == _deviceMemory->_mtlStorageMode) {
-                _mtlTexelBuffer = [_deviceMemory->_mtlHeap newBufferWithLength: _byteCount options: _deviceMemory->getMTLResourceOptions() offset: getDeviceMemoryOffset()];
+                _mtlTexelBuffer = [_deviceMemory->_mtlHeap newBufferWithLength: _byteCount options: _deviceMemory->getMTLResourceOptions() offset: _deviceMemory->getMTLHeapOffset() + getDeviceMemoryOffset()];
                 if (_image->_isAliasable) { [_mtlTexelBuffer makeAliasable]; }
             } else {
                 _mtlTexelBuffer = [getMTLDevice() newBufferWithLength: _byteCount options: _image->getMTLStorageMode() << MTLResourceStorageModeShift];
@@ -1648,6 +1735,8 @@ id<MTLTexture> MVKPresentableSwapchainImage::getMTLTexture(uint8_t planeIndex) {
 // Pass MVKImagePresentInfo by value because it may not exist when the callback runs.
 VkResult MVKPresentableSwapchainImage::presentCAMetalDrawable(id<MTLCommandBuffer> mtlCmdBuff,
 															  MVKImagePresentInfo presentInfo) {
+	if (_mtlTextureHeadless) { return presentHeadless(mtlCmdBuff, presentInfo); }
+
 	_swapchain->renderWatermark(getMTLTexture(0), mtlCmdBuff);
 
 	// According to Apple, it is more performant to call MTLDrawable present from within a
@@ -1695,6 +1784,31 @@ VkResult MVKPresentableSwapchainImage::presentCAMetalDrawable(id<MTLCommandBuffe
 	return getConfigurationResult();
 }
 
+// A headless surface has no drawable to present, and no display to wait for, regardless of the present mode.
+// The presentation completes, and this image is recycled for acquisition, as soon as the GPU completes the work
+// submitted ahead of the presentation, and the time of that completion is reported as the presentation time.
+// Pass MVKImagePresentInfo by value because it may not exist when the callback runs.
+VkResult MVKPresentableSwapchainImage::presentHeadless(id<MTLCommandBuffer> mtlCmdBuff,
+													   MVKImagePresentInfo presentInfo) {
+	_swapchain->renderWatermark(_mtlTextureHeadless, mtlCmdBuff);
+
+	MVKSwapchainSignaler signaler = getPresentationSignaler();
+	beginPresentation(presentInfo);		// Retains this image until endPresentation()
+
+	auto* fence = presentInfo.fence;
+	if (fence) { fence->retain(); }
+	[mtlCmdBuff addCompletedHandler: ^(id<MTLCommandBuffer> mcb) {
+		signal(fence);
+		if (fence) { fence->release(); }
+		if (_swapchain) { _swapchain->notifyPresentComplete(presentInfo); }
+		endPresentation(presentInfo, signaler);		// Must be last, because it releases this image.
+	}];
+
+	signal(signaler.semaphore, signaler.semaphoreSignalToken, mtlCmdBuff);
+
+	return getConfigurationResult();
+}
+
 MVKSwapchainSignaler MVKPresentableSwapchainImage::getPresentationSignaler() {
 	lock_guard<mutex> lock(_availabilityLock);
 
@@ -1767,6 +1881,13 @@ void MVKPresentableSwapchainImage::endPresentation(const MVKImagePresentInfo& pr
 	release();
 }
 
+// The MTLCommandBuffer completion handler that would have released this frame from the
+// frame pacing count of the swapchain will never run, so release the frame here instead.
+void MVKPresentableSwapchainImage::abandonPresentation(const MVKImagePresentInfo& presentInfo) {
+	lock_guard<mutex> lock(_detachmentLock);
+	if (_swapchain) { _swapchain->notifyPresentComplete(presentInfo); }
+}
+
 // Releases the CAMetalDrawable underlying this image.
 void MVKPresentableSwapchainImage::releaseMetalDrawable() {
     [_mtlDrawable release];
@@ -1806,10 +1927,10 @@ MVKPresentableSwapchainImage::MVKPresentableSwapchainImage(MVKDevice* device,
 																								  width: pCreateInfo->extent.width
 																								 height: pCreateInfo->extent.height
 																							  mipmapped: NO];
-			mtlTexDesc.usage = MTLTextureUsageRenderTarget;
+			mtlTexDesc.usage = getMTLTextureUsage(getMTLPixelFormat());
 			mtlTexDesc.storageMode = MTLStorageModePrivate;
 
-			_mtlTextureHeadless = [[getMTLDevice() newTextureWithDescriptor: mtlTexDesc] retain];	// retained
+			_mtlTextureHeadless = [getMTLDevice() newTextureWithDescriptor: mtlTexDesc];	// retained
 		}
 	}
 }
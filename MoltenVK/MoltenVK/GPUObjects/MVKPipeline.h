@@ -250,6 +250,9 @@ public:
 	/** Returns whether this pipeline has tessellation shaders. */
 	bool isTessellationPipeline() { return _isTessellationPipeline; }
 
+	/** Returns whether binding this pipeline changes the color attachment locations of the current renderpass. */
+	bool hasRemappedAttachmentLocations() { return _hasRemappedAttachmentLocations; }
+
 	/** Returns the number of output tessellation patch control points. */
 	uint32_t getOutputControlPointCount() { return _outputControlPointCount; }
 
@@ -498,6 +501,9 @@ public:
 	/** Merges the contents of the specified number of pipeline caches into this cache. */
 	VkResult mergePipelineCaches(uint32_t srcCacheCount, const VkPipelineCache* pSrcCaches);
 
+	/** Returns whether the app has promised to synchronize access to this cache, so that it does not need to lock. */
+	bool isExternallySynchronized() { return _isExternallySynchronized; }
+
 #pragma mark Construction
 
 	/** Constructs an instance for the specified device. */
@@ -20,6 +20,8 @@
 
 #include "MVKDevice.h"
 #include "MVKSmallVector.h"
+#include <atomic>
+#include <memory>
 #include <mutex>
 #include <condition_variable>
 
@@ -95,18 +97,35 @@ public:
     /** Returns whether queryCount queries starting at firstQuery are available on the device. */
     bool areQueriesDeviceAvailable(uint32_t firstQuery, uint32_t queryCount);
 
+	/** Returns the number of bytes written for the result of each query, when copied with the specified flags. */
+	VkDeviceSize getResultSize(VkQueryResultFlags flags) {
+		uint32_t valCnt = _queryElementCount + (mvkAreAllFlagsEnabled(flags, VK_QUERY_RESULT_WITH_AVAILABILITY_BIT) ? 1 : 0);
+		return valCnt * (mvkAreAllFlagsEnabled(flags, VK_QUERY_RESULT_64_BIT) ? sizeof(uint64_t) : sizeof(uint32_t));
+	}
+
 #pragma mark Construction
 
 	MVKQueryPool(MVKDevice* device,
 				 const VkQueryPoolCreateInfo* pCreateInfo,
-				 const uint32_t queryElementCount) : MVKVulkanAPIDeviceObject(device),
-                    _availability(pCreateInfo->queryCount, Initial),
-                    _queryElementCount(queryElementCount) {}
+				 const uint32_t queryElementCount);
 
 protected:
+	/** The possible states of a query. */
+	enum Status {
+		Initial,            /**< Initial state when created or reset. */
+		DeviceAvailable,    /**< Query was ended and is available on the device. */
+		Available           /**< Query is available to the host. */
+	};
+
 	bool areQueriesHostAvailable(uint32_t firstQuery, uint32_t endQuery);
+	bool areQueriesAvailable(uint32_t firstQuery, uint32_t endQuery);
+	Status getStatus(uint32_t query);
+	void setStatus(uint32_t firstQuery, uint32_t endQuery, Status status);
+	template <typename F> bool forEachAvailabilityWord(uint32_t firstQuery, uint32_t endQuery, F func);
+	void notifyAvailabilityWaiters();
 	virtual NSData* getQuerySourceData(uint32_t firstQuery, uint32_t queryCount) { return nil; }
     VkResult getResult(uint32_t query, NSData* srcData, uint32_t srcDataQueryOffset, void* pDstData, VkQueryResultFlags flags);
+	void copyAvailableResults(const uint64_t* pSrcData, uint32_t queryCount, void* pData, VkDeviceSize stride, VkQueryResultFlags flags);
 	virtual id<MTLBuffer> getResultBuffer(MVKCommandEncoder* cmdEncoder, uint32_t firstQuery, uint32_t queryCount, NSUInteger& offset) { return nil; }
 	virtual id<MTLComputeCommandEncoder> encodeComputeCopyResults(MVKCommandEncoder* cmdEncoder, uint32_t firstQuery, uint32_t queryCount, uint32_t index) { return nil; }
 	virtual void encodeDirectCopyResults(MVKCommandEncoder* cmdEncoder, uint32_t firstQuery, uint32_t queryCount,
@@ -121,16 +140,17 @@ protected:
 		VkQueryResultFlags flags;
 	};
 
-	/** The possible states of a query. */
-	enum Status {
-		Initial,            /**< Initial state when created or reset. */
-		DeviceAvailable,    /**< Query was ended and is available on the device. */
-		Available           /**< Query is available to the host. */
-	};
+	// The Status of each query is held in 2 bits of an array of atomic 64-bit words, so the status
+	// of a range of queries can be tested and updated a word at a time, without locking.
+	static constexpr uint32_t kMVKQueryStatusBitCount = 2;
+	static constexpr uint32_t kMVKQueryStatusesPerWord = 64 / kMVKQueryStatusBitCount;
+	static constexpr uint64_t kMVKQueryStatusLowBits = 0x5555555555555555ULL;
 
-	MVKSmallVector<Status, kMVKDefaultQueryCount> _availability;
+	std::unique_ptr<std::atomic<uint64_t>[]> _availability;
 	MVKSmallVector<DeferredCopy, 4> _deferredCopies;
+	uint32_t _queryCount;
 	uint32_t _queryElementCount;
+	std::atomic<uint32_t> _availabilityWaiterCount = 0;
 	std::mutex _availabilityLock;
 	std::condition_variable _availabilityBlocker;
 	std::mutex _deferredCopiesLock;
@@ -33,10 +33,7 @@ using namespace std;
 void MVKQueryPool::endQuery(uint32_t query, MVKCommandEncoder* cmdEncoder) {
     uint32_t queryCount = cmdEncoder->isInRenderPass() ? cmdEncoder->getSubpass()->getViewCountInMetalPass(cmdEncoder->getMultiviewPassIndex()) : 1;
     queryCount = max(queryCount, 1u);
-    lock_guard<mutex> lock(_availabilityLock);
-    for (uint32_t i = query; i < query + queryCount; ++i) {
-        _availability[i] = DeviceAvailable;
-    }
+    setStatus(query, query + queryCount, DeviceAvailable);
     lock_guard<mutex> copyLock(_deferredCopiesLock);
     if (!_deferredCopies.empty()) {
         // Partition by readiness.
@@ -51,23 +48,32 @@ void MVKQueryPool::endQuery(uint32_t query, MVKCommandEncoder* cmdEncoder) {
     }
 }
 
-// Mark queries as available
+// Mark queries as available, moving each from DeviceAvailable to Available atomically,
+// so a concurrent reset, which moves it to Initial, is not overwritten.
 void MVKQueryPool::finishQueries(MVKArrayRef<const uint32_t> queries) {
-    lock_guard<mutex> lock(_availabilityLock);
-    for (uint32_t qry : queries) {
-        if (_availability[qry] == DeviceAvailable) {
-            _availability[qry] = Available;
-        }
-    }
-    _availabilityBlocker.notify_all();      // Predicate of each wait() call will check whether all required queries are available
+	for (uint32_t qry : queries) {
+		auto& word = _availability[qry / kMVKQueryStatusesPerWord];
+		uint32_t shift = (qry % kMVKQueryStatusesPerWord) * kMVKQueryStatusBitCount;
+		uint64_t fieldMask = uint64_t(3) << shift;
+		uint64_t oldWord = word.load(memory_order_relaxed);
+		while (((oldWord & fieldMask) >> shift) == DeviceAvailable &&
+			   !word.compare_exchange_weak(oldWord, (oldWord & ~fieldMask) | (uint64_t(Available) << shift))) {}
+	}
+	notifyAvailabilityWaiters();
 }
 
 void MVKQueryPool::resetResults(uint32_t firstQuery, uint32_t queryCount, MVKCommandEncoder* cmdEncoder) {
-    lock_guard<mutex> lock(_availabilityLock);
-    uint32_t endQuery = firstQuery + queryCount;
-    for (uint32_t query = firstQuery; query < endQuery; query++) {
-        _availability[query] = Initial;
-    }
+	setStatus(firstQuery, firstQuery + queryCount, Initial);
+}
+
+// Waiting threads increment the waiter count before testing availability, and availability is
+// updated before the waiter count is tested here, using sequentially-consistent ordering, so
+// either a waiting thread sees the change in availability, or it is notified here.
+void MVKQueryPool::notifyAvailabilityWaiters() {
+	if (_availabilityWaiterCount) {
+		lock_guard<mutex> lock(_availabilityLock);
+		_availabilityBlocker.notify_all();      // Predicate of each wait() call will check whether all required queries are available
+	}
 }
 
 VkResult MVKQueryPool::getResults(uint32_t firstQuery,
@@ -78,34 +84,72 @@ VkResult MVKQueryPool::getResults(uint32_t firstQuery,
 								  VkQueryResultFlags flags) {
 	if (_device->getConfigurationResult() != VK_SUCCESS) { return _device->getConfigurationResult(); }
 
-	unique_lock<mutex> lock(_availabilityLock);
-
 	uint32_t endQuery = firstQuery + queryCount;
 
-	if (mvkAreAllFlagsEnabled(flags, VK_QUERY_RESULT_WAIT_BIT)) {
+	if (mvkAreAllFlagsEnabled(flags, VK_QUERY_RESULT_WAIT_BIT) && !areQueriesHostAvailable(firstQuery, endQuery)) {
+		unique_lock<mutex> lock(_availabilityLock);
+		_availabilityWaiterCount++;
 		_availabilityBlocker.wait(lock, [this, firstQuery, endQuery]{
 			return areQueriesHostAvailable(firstQuery, endQuery);
 		});
+		_availabilityWaiterCount--;
 	}
 
 	VkResult rqstRslt = VK_SUCCESS;
 	@autoreleasepool {
 		NSData* srcData = getQuerySourceData(firstQuery, queryCount);
-		uintptr_t pDstData = (uintptr_t)pData;
-		for (uint32_t query = firstQuery; query < endQuery; query++, pDstData += stride) {
-			VkResult qryRslt = getResult(query, srcData, firstQuery, (void*)pDstData, flags);
-			if (rqstRslt == VK_SUCCESS) { rqstRslt = qryRslt; }
+		if (srcData && areQueriesAvailable(firstQuery, endQuery)) {
+			copyAvailableResults((const uint64_t*)srcData.bytes, queryCount, pData, stride, flags);
+		} else {
+			uintptr_t pDstData = (uintptr_t)pData;
+			for (uint32_t query = firstQuery; query < endQuery; query++, pDstData += stride) {
+				VkResult qryRslt = getResult(query, srcData, firstQuery, (void*)pDstData, flags);
+				if (rqstRslt == VK_SUCCESS) { rqstRslt = qryRslt; }
+			}
 		}
 	}
 	return rqstRslt;
 }
 
+// Calls the function with each availability word that holds the status of any of the queries between
+// the start (inclusive) and end (exclusive) queries, and a mask of the low bit of the status of each
+// of those queries within the word. Stops, and returns false, if the function returns false.
+template <typename F>
+bool MVKQueryPool::forEachAvailabilityWord(uint32_t firstQuery, uint32_t endQuery, F func) {
+	if (firstQuery >= endQuery) { return true; }
+
+	uint32_t endWordIdx = (endQuery - 1) / kMVKQueryStatusesPerWord + 1;
+	for (uint32_t wordIdx = firstQuery / kMVKQueryStatusesPerWord; wordIdx < endWordIdx; wordIdx++) {
+		uint32_t wordFirstQuery = wordIdx * kMVKQueryStatusesPerWord;
+		uint32_t firstField = max(firstQuery, wordFirstQuery) - wordFirstQuery;
+		uint32_t endField = min(endQuery, wordFirstQuery + kMVKQueryStatusesPerWord) - wordFirstQuery;
+		uint32_t fieldBitCount = (endField - firstField) * kMVKQueryStatusBitCount;
+		uint64_t fieldsMask = (fieldBitCount == 64 ? ~0ULL : (1ULL << fieldBitCount) - 1) << (firstField * kMVKQueryStatusBitCount);
+		if ( !func(_availability[wordIdx], fieldsMask & kMVKQueryStatusLowBits) ) { return false; }
+	}
+	return true;
+}
+
+MVKQueryPool::Status MVKQueryPool::getStatus(uint32_t query) {
+	uint64_t word = _availability[query / kMVKQueryStatusesPerWord].load(memory_order_acquire);
+	return Status((word >> ((query % kMVKQueryStatusesPerWord) * kMVKQueryStatusBitCount)) & 3);
+}
+
+void MVKQueryPool::setStatus(uint32_t firstQuery, uint32_t endQuery, Status status) {
+	forEachAvailabilityWord(firstQuery, endQuery, [status](atomic<uint64_t>& word, uint64_t lowBits) {
+		uint64_t fieldsMask = lowBits | (lowBits << 1);
+		uint64_t fieldsVal = lowBits * status;
+		uint64_t oldWord = word.load(memory_order_relaxed);
+		while ( !word.compare_exchange_weak(oldWord, (oldWord & ~fieldsMask) | fieldsVal) ) {}
+		return true;
+	});
+}
+
 bool MVKQueryPool::areQueriesDeviceAvailable(uint32_t firstQuery, uint32_t queryCount) {
-	uint32_t endQuery = firstQuery + queryCount;
-    for (uint32_t query = firstQuery; query < endQuery; query++) {
-        if ( _availability[query] < DeviceAvailable ) { return false; }
-    }
-    return true;
+	return forEachAvailabilityWord(firstQuery, firstQuery + queryCount, [](atomic<uint64_t>& word, uint64_t lowBits) {
+		uint64_t val = word.load(memory_order_acquire);
+		return ((val | (val >> 1)) & lowBits) == lowBits;	// No status is Initial
+	});
 }
 
 // Returns whether any queries between the start (inclusive) and end (exclusive) queries,
@@ -113,20 +157,27 @@ bool MVKQueryPool::areQueriesDeviceAvailable(uint32_t firstQuery, uint32_t query
 // Queries that were not encoded to be written, will be in Initial state.
 // Queries that were encoded to be written, and are available, will be in Available state.
 // Queries that were encoded to be written, but are not available, will be in DeviceAvailable state.
+// Availability is loaded with sequentially-consistent ordering, as required by notifyAvailabilityWaiters().
 bool MVKQueryPool::areQueriesHostAvailable(uint32_t firstQuery, uint32_t endQuery) {
     // If we lost the device, stop waiting immediately.
     if (_device->getConfigurationResult() != VK_SUCCESS) { return true; }
-    for (uint32_t query = firstQuery; query < endQuery; query++) {
-        if (_availability[query] == DeviceAvailable) { return false; }
-    }
-    return true;
+	return forEachAvailabilityWord(firstQuery, endQuery, [](atomic<uint64_t>& word, uint64_t lowBits) {
+		return (word.load() & lowBits) == 0;		// No status is DeviceAvailable
+	});
+}
+
+// Returns whether all queries between the start (inclusive) and end (exclusive) queries are in Available state.
+bool MVKQueryPool::areQueriesAvailable(uint32_t firstQuery, uint32_t endQuery) {
+	return forEachAvailabilityWord(firstQuery, endQuery, [](atomic<uint64_t>& word, uint64_t lowBits) {
+		return (word.load(memory_order_acquire) & (lowBits | (lowBits << 1))) == (lowBits << 1);
+	});
 }
 
 VkResult MVKQueryPool::getResult(uint32_t query, NSData* srcData, uint32_t srcDataQueryOffset, void* pDstData, VkQueryResultFlags flags) {
 
 	if (_device->getConfigurationResult() != VK_SUCCESS) { return _device->getConfigurationResult(); }
 
-	bool isAvailable = _availability[query] == Available;
+	bool isAvailable = getStatus(query) == Available;
 	bool shouldOutput = (isAvailable || mvkAreAllFlagsEnabled(flags, VK_QUERY_RESULT_PARTIAL_BIT));
 	bool shouldOutput64Bit = mvkAreAllFlagsEnabled(flags, VK_QUERY_RESULT_64_BIT);
 
@@ -154,6 +205,50 @@ VkResult MVKQueryPool::getResult(uint32_t query, NSData* srcData, uint32_t srcDa
 	return shouldOutput ? VK_SUCCESS : VK_NOT_READY;
 }
 
+// Copies the results of a range of queries that are all available, without testing each query.
+// Tightly packed 64-bit results are copied directly. Otherwise, each loop is specialized for the
+// result size and presence of the availability value, so it can be vectorized by the compiler.
+void MVKQueryPool::copyAvailableResults(const uint64_t* pSrcData,
+										uint32_t queryCount,
+										void* pData,
+										VkDeviceSize stride,
+										VkQueryResultFlags flags) {
+	bool is64Bit = mvkAreAllFlagsEnabled(flags, VK_QUERY_RESULT_64_BIT);
+	bool withAvailability = mvkAreAllFlagsEnabled(flags, VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+	uintptr_t pDstData = (uintptr_t)pData;
+
+	if (is64Bit) {
+		size_t availOffset = _queryElementCount * sizeof(uint64_t);
+		if (withAvailability) {
+			for (uint32_t i = 0; i < queryCount; i++, pDstData += stride) {
+				*(uint64_t*)pDstData = pSrcData[i];
+				*(uint64_t*)(pDstData + availOffset) = 1;
+			}
+		} else if (stride == sizeof(uint64_t)) {
+			memcpy(pData, pSrcData, queryCount * sizeof(uint64_t));
+		} else {
+			for (uint32_t i = 0; i < queryCount; i++, pDstData += stride) {
+				*(uint64_t*)pDstData = pSrcData[i];
+			}
+		}
+	} else {
+		size_t availOffset = _queryElementCount * sizeof(uint32_t);
+		if (withAvailability) {
+			for (uint32_t i = 0; i < queryCount; i++, pDstData += stride) {
+				*(uint32_t*)pDstData = (uint32_t)pSrcData[i];
+				*(uint32_t*)(pDstData + availOffset) = 1;
+			}
+		} else if (stride == sizeof(uint32_t)) {
+			uint32_t* pDst32 = (uint32_t*)pData;
+			for (uint32_t i = 0; i < queryCount; i++) { pDst32[i] = (uint32_t)pSrcData[i]; }
+		} else {
+			for (uint32_t i = 0; i < queryCount; i++, pDstData += stride) {
+				*(uint32_t*)pDstData = (uint32_t)pSrcData[i];
+			}
+		}
+	}
+}
+
 void MVKQueryPool::encodeCopyResults(MVKCommandEncoder* cmdEncoder,
 									 uint32_t firstQuery,
 									 uint32_t queryCount,
@@ -182,9 +277,12 @@ void MVKQueryPool::encodeCopyResults(MVKCommandEncoder* cmdEncoder,
 		state.bindStructBytes(mtlComputeCmdEnc, &stride,     2);
 		state.bindStructBytes(mtlComputeCmdEnc, &queryCount, 3);
 		state.bindStructBytes(mtlComputeCmdEnc, &flags,      4);
-		_availabilityLock.lock();
-		cmdEncoder->setComputeBytes(mtlComputeCmdEnc, _availability.data() + firstQuery, queryCount * sizeof(Status), 5);
-		_availabilityLock.unlock();
+		MVKSmallVector<Status, kMVKDefaultQueryCount> statuses;
+		statuses.reserve(queryCount);
+		for (uint32_t query = firstQuery; query < firstQuery + queryCount; query++) {
+			statuses.push_back(getStatus(query));
+		}
+		cmdEncoder->setComputeBytes(mtlComputeCmdEnc, statuses.data(), queryCount * sizeof(Status), 5);
 
 		// Run one thread per query. Try to fill up a subgroup.
 		NSUInteger threadCount = NSUInteger(queryCount);
@@ -216,6 +314,19 @@ void MVKQueryPool::encodeDirectCopyResults(MVKCommandEncoder* cmdEncoder,
 							 size: stride * queryCount];
 }
 
+MVKQueryPool::MVKQueryPool(MVKDevice* device,
+						   const VkQueryPoolCreateInfo* pCreateInfo,
+						   const uint32_t queryElementCount) :
+	MVKVulkanAPIDeviceObject(device),
+	_queryCount(pCreateInfo->queryCount),
+	_queryElementCount(queryElementCount) {
+
+	// All queries start in Initial state, which has a value of zero.
+	uint32_t wordCount = max((_queryCount + kMVKQueryStatusesPerWord - 1) / kMVKQueryStatusesPerWord, 1u);
+	_availability.reset(new atomic<uint64_t>[wordCount]);
+	for (uint32_t wordIdx = 0; wordIdx < wordCount; wordIdx++) { _availability[wordIdx] = 0; }
+}
+
 void MVKQueryPool::deferCopyResults(uint32_t firstQuery,
 									uint32_t queryCount,
 									MVKBuffer* destBuffer,
@@ -22,6 +22,7 @@
 #include "MVKCommandBuffer.h"
 #include "MVKImage.h"
 #include "MVKSync.h"
+#include "MVKObjectPool.h"
 #include "MVKSmallVector.h"
 #include <mutex>
 #include <condition_variable>
@@ -30,6 +31,9 @@
 
 class MVKQueue;
 class MVKQueueSubmission;
+class MVKQueueCommandBufferSubmission;
+class MVKQueuePresentSurfaceSubmission;
+template <class T> class MVKQueueSubmissionPool;
 class MVKPhysicalDevice;
 class MVKGPUCaptureScope;
 
@@ -102,6 +106,9 @@ public:
 	/** Block the current thread until this queue is idle. */
 	VkResult waitIdle(MVKCommandUse cmdUse);
 
+	/** Submits any command buffer submissions that are being held in a batch. */
+	void flushSubmissionBatch();
+
 #pragma mark Metal
 
 	/** Returns the Metal queue underlying this queue. */
@@ -110,11 +117,16 @@ public:
 	/** Returns a Metal command buffer from the Metal queue. */
 	id<MTLCommandBuffer> getMTLCommandBuffer(MVKCommandUse cmdUse, bool retainRefs = false);
 
+	/** Returns the number of Metal command buffers retrieved from the Metal queue that have not yet completed. */
+	uint32_t getActiveMTLCommandBufferCount() { return _activeMTLCommandBufferCount; }
+
 #pragma mark Construction
 	
 	/** Constructs an instance for the device and queue family. */
 	MVKQueue(MVKDevice* device, MVKQueueFamily* queueFamily, uint32_t index, float priority, VkQueueGlobalPriority globalPriority);
 
+	void destroy() override;
+
 	~MVKQueue() override;
 
     /**
@@ -142,6 +154,21 @@ protected:
 	void initMTLCommandQueue();
 	void destroyExecQueue();
 	VkResult submit(MVKQueueSubmission* qSubmit);
+	VkResult enqueue(MVKQueueSubmission* qSubmit);
+	template <typename S>
+	bool canBatchSubmission(const S* pSubmit, VkFence fence, MVKCommandUse cmdUse);
+	template <typename S>
+	VkResult addToSubmissionBatch(const S* pSubmit, MVKCommandUse cmdUse);
+	void flushSubmissionBatchLocked();
+	void scheduleSubmissionBatchFlush(uint64_t timeout);
+	void destroySubmissionBatchTimer();
+	uint64_t getSubmissionBatchTimeout();
+	void trackMTLCommandBufferExecution(uint64_t startTime);
+	void executeQueued(MVKQueueSubmission* qSubmit);
+	bool deferUntilWaitsSignaled(MVKQueueSubmission* qSubmit);
+	void signalDeferredWait(MVKQueueSubmission* qSubmit);
+	template <typename S>
+	MVKQueueCommandBufferSubmission* acquireCommandBufferSubmission(const S* pSubmit, VkFence fence, MVKCommandUse cmdUse);
 	NSString* getMTLCommandBufferLabel(MVKCommandUse cmdUse);
 	void handleMTLCommandBufferError(id<MTLCommandBuffer> mtlCmdBuff);
 
@@ -161,6 +188,17 @@ protected:
 	NSString* _mtlCmdBuffLabelInvalidateMappedMemoryRanges = nil;
 	NSString* _mtlCmdBuffLabelCopyImageToMemory = nil;
 	MVKGPUCaptureScope* _submissionCaptureScope = nil;
+	MVKQueueSubmissionPool<MVKQueueCommandBufferSubmission>* _commandBufferSubmissionPool = nullptr;
+	MVKQueueSubmissionPool<MVKQueuePresentSurfaceSubmission>* _presentSubmissionPool = nullptr;
+	MVKQueueCommandBufferSubmission* _submissionBatch = nullptr;
+	std::mutex _submissionBatchLock;
+	dispatch_source_t _submissionBatchTimer = nullptr;
+	uint64_t _submissionBatchingTimeout = 0;
+	std::atomic<uint64_t> _averageMTLCommandBufferExecutionTime = 0;
+	std::atomic<uint32_t> _activeMTLCommandBufferCount = 0;
+	std::atomic<bool> _hasWarnedOfMTLCommandBufferLimit = false;
+	uint32_t _maxActiveMTLCommandBufferCount = 0;
+	uint32_t _mtlCommandBufferPressureCount = 0;
 	float _priority;
 	VkQueueGlobalPriority _globalPriority;
 	uint32_t _index;
@@ -180,6 +218,7 @@ public:
 
 	void encodeWait(id<MTLCommandBuffer> mtlCmdBuff);
 	void encodeSignal(id<MTLCommandBuffer> mtlCmdBuff);
+	bool notifyWhenSignaled(std::function<void()> handler);
 	MVKSemaphoreSubmitInfo(const VkSemaphoreSubmitInfo& semaphoreSubmitInfo);
 	MVKSemaphoreSubmitInfo(const VkSemaphore semaphore, VkPipelineStageFlags stageMask);
 	MVKSemaphoreSubmitInfo(const MVKSemaphoreSubmitInfo& other);
@@ -188,7 +227,13 @@ public:
 
 } MVKSemaphoreSubmitInfo;
 
-/** This is an abstract class for an operation that can be submitted to an MVKQueue. */
+/**
+ * This is an abstract class for an operation that can be submitted to an MVKQueue.
+ *
+ * Instances are held in pools in the MVKQueue, and are reused across submissions.
+ * Each time an instance is acquired from its pool, it is initialized for the submission,
+ * and when the submission finishes, the instance is reset and returned to its pool.
+ */
 class MVKQueueSubmission : public MVKBaseDeviceObject, public MVKConfigurableMixin {
 
 public:
@@ -197,31 +242,30 @@ public:
 	MVKVulkanAPIObject* getVulkanAPIObject() override { return _queue->getVulkanAPIObject(); }
 
 	/**
-	 * Executes this action on the queue and then disposes of this instance.
+	 * Executes this action on the queue and then returns this instance to its pool.
 	 *
 	 * Upon completion of this function, no further calls should be made to this instance.
 	 */
 	virtual VkResult execute() = 0;
 
-	MVKQueueSubmission(MVKQueue* queue,
-					   uint32_t waitSemaphoreInfoCount,
-					   const VkSemaphoreSubmitInfo* pWaitSemaphoreSubmitInfos);
-
-	MVKQueueSubmission(MVKQueue* queue,
-					   uint32_t waitSemaphoreCount,
-					   const VkSemaphore* pWaitSemaphores,
-					   const VkPipelineStageFlags* pWaitDstStageMask);
-
-	~MVKQueueSubmission() override;
+	MVKQueueSubmission(MVKQueue* queue) : MVKBaseDeviceObject(queue->getDevice()), _queue(queue) {}
 
 protected:
 	friend class MVKQueue;
 
 	virtual void finish() = 0;
 	MVKDevice* getDevice() { return _queue->getDevice(); }
+	void initSubmission(uint32_t waitSemaphoreInfoCount,
+						const VkSemaphoreSubmitInfo* pWaitSemaphoreSubmitInfos);
+	void initSubmission(uint32_t waitSemaphoreCount,
+						const VkSemaphore* pWaitSemaphores,
+						const VkPipelineStageFlags* pWaitDstStageMask);
+	void resetSubmission();
 
 	MVKQueue* _queue;
 	MVKSmallVector<MVKSemaphoreSubmitInfo> _waitSemaphores;
+	std::atomic<uint32_t> _unsignaledWaitCount = 0;
+	bool _emulatedWaitDone = false;		//Used to track if we've already waited for emulated semaphores.
 	uint64_t _creationTime;
 };
 
@@ -239,23 +283,33 @@ typedef struct MVKCommandBufferSubmitInfo {
 } MVKCommandBufferSubmitInfo;
 
 /**
- * Submits an empty set of command buffers to the queue.
- * Used for fence-only command submissions.
+ * Submits the commands in a set of command buffers to the queue.
+ * An empty set of command buffers is used for fence-only command submissions.
  */
-class MVKQueueCommandBufferSubmission : public MVKQueueSubmission {
+class MVKQueueCommandBufferSubmission : public MVKQueueSubmission, public MVKLinkableMixin<MVKQueueCommandBufferSubmission> {
 
 public:
 	VkResult execute() override;
 
-	MVKQueueCommandBufferSubmission(MVKQueue* queue, 
-									const VkSubmitInfo2* pSubmit,
-									VkFence fence, 
-									MVKCommandUse cmdUse);
+	/** Initializes this instance for a submission. A null pSubmit is used to only signal the fence. */
+	void init(const VkSubmitInfo2* pSubmit, VkFence fence, MVKCommandUse cmdUse);
+
+	/** Initializes this instance for a submission. A null pSubmit is used to only signal the fence. */
+	void init(const VkSubmitInfo* pSubmit, VkFence fence, MVKCommandUse cmdUse);
 
-	MVKQueueCommandBufferSubmission(MVKQueue* queue, 
-									const VkSubmitInfo* pSubmit,
-									VkFence fence,
-									MVKCommandUse cmdUse);
+	/**
+	 * Appends the command buffers of the submission to the command buffers of this instance,
+	 * and returns the configuration result of the appended command buffers.
+	 */
+	VkResult addCommandBuffers(const VkSubmitInfo2* pSubmit);
+
+	/**
+	 * Appends the command buffers of the submission to the command buffers of this instance,
+	 * and returns the configuration result of the appended command buffers.
+	 */
+	VkResult addCommandBuffers(const VkSubmitInfo* pSubmit);
+
+	MVKQueueCommandBufferSubmission(MVKQueue* queue) : MVKQueueSubmission(queue) {}
 
 	~MVKQueueCommandBufferSubmission() override;
 
@@ -266,57 +320,67 @@ protected:
 	void setActiveMTLCommandBuffer(id<MTLCommandBuffer> mtlCmdBuff);
 	VkResult commitActiveMTLCommandBuffer(bool signalCompletion = false);
 	void finish() override;
-	virtual void submitCommandBuffers() {}
+	void submitCommandBuffers();
+	void reset();
 
 	MVKCommandEncodingContext _encodingContext;
+	MVKSmallVector<MVKCommandBufferSubmitInfo, 16> _cmdBuffers;
 	MVKSmallVector<MVKSemaphoreSubmitInfo> _signalSemaphores;
 	MVKFence* _fence = nullptr;
 	id<MTLCommandBuffer> _activeMTLCommandBuffer = nil;
 	MVKCommandUse _commandUse = kMVKCommandUseNone;
-	bool _emulatedWaitDone = false;		//Used to track if we've already waited for emulated semaphores.
 };
 
 
-/**
- * Submits the commands in a set of command buffers to the queue.
- * Template class to balance vector pre-allocations between very common low counts and fewer larger counts.
- */
-template <size_t N>
-class MVKQueueFullCommandBufferSubmission : public MVKQueueCommandBufferSubmission {
+#pragma mark -
+#pragma mark MVKQueuePresentSurfaceSubmission
+
+/** Presents a swapchain surface image to the OS. */
+class MVKQueuePresentSurfaceSubmission : public MVKQueueSubmission, public MVKLinkableMixin<MVKQueuePresentSurfaceSubmission> {
 
 public:
-	MVKQueueFullCommandBufferSubmission(MVKQueue* queue, 
-										const VkSubmitInfo2* pSubmit,
-										VkFence fence,
-										MVKCommandUse cmdUse);
+	VkResult execute() override;
 
-	MVKQueueFullCommandBufferSubmission(MVKQueue* queue, 
-										const VkSubmitInfo* pSubmit,
-										VkFence fence,
-										MVKCommandUse cmdUse);
+	/** Initializes this instance for a presentation. */
+	void init(const VkPresentInfoKHR* pPresentInfo);
+
+	MVKQueuePresentSurfaceSubmission(MVKQueue* queue) : MVKQueueSubmission(queue) {}
 
 protected:
-	void submitCommandBuffers() override;
+	void finish() override;
+	void reset();
 
-	MVKSmallVector<MVKCommandBufferSubmitInfo, N> _cmdBuffers;
+	MVKSmallVector<MVKImagePresentInfo, 4> _presentInfo;
 };
 
 
 #pragma mark -
-#pragma mark MVKQueuePresentSurfaceSubmission
+#pragma mark MVKQueueSubmissionPool
 
-/** Presents a swapchain surface image to the OS. */
-class MVKQueuePresentSurfaceSubmission : public MVKQueueSubmission {
+/**
+ * Manages a pool of queue submissions of a particular type, so that submissions to a queue can reuse
+ * instances, and their content storage, instead of allocating and freeing an instance for each submission.
+ *
+ * Instances are acquired when a submission is made, and returned from the completion handler of the
+ * MTLCommandBuffer on another thread, so the thread-safe versions of the pool functions must be used.
+ */
+template <class T>
+class MVKQueueSubmissionPool : public MVKObjectPool<T> {
 
 public:
-	VkResult execute() override;
 
-	MVKQueuePresentSurfaceSubmission(MVKQueue* queue,
-									 const VkPresentInfoKHR* pPresentInfo);
+	/** Returns the Vulkan API opaque object controlling this object. */
+	MVKVulkanAPIObject* getVulkanAPIObject() override { return _queue->getVulkanAPIObject(); };
+
+	/**
+	 * Configures this instance for the queue, and either use pooling, or not, depending
+	 * on the value of isPooling, which defaults to true if not indicated explicitly.
+	 */
+	MVKQueueSubmissionPool(MVKQueue* queue, bool isPooling = true) : MVKObjectPool<T>(isPooling), _queue(queue) {}
 
 protected:
-	void finish() override;
+	T* newObject() override { return new T(_queue); }
 
-	MVKSmallVector<MVKImagePresentInfo, 4> _presentInfo;
+	MVKQueue* _queue;
 };
 
@@ -71,11 +71,20 @@ void MVKQueue::propagateDebugName() { setMetalObjectLabel(_mtlQueue, _debugName)
 // This is critical for apps that don't use standard OS autoreleasing runloop threading.
 static inline VkResult execute(MVKQueueSubmission* qSubmit) { @autoreleasepool { return qSubmit->execute(); } }
 
+// If submissions are being batched, any batch being held must be submitted first, to preserve submission order.
+VkResult MVKQueue::submit(MVKQueueSubmission* qSubmit) {
+	if ( !_submissionBatchingTimeout ) { return enqueue(qSubmit); }
+
+	lock_guard<mutex> lock(_submissionBatchLock);
+	flushSubmissionBatchLocked();
+	return enqueue(qSubmit);
+}
+
 // Executes the submmission, either immediately, or by dispatching to an execution queue.
 // Submissions to the execution queue are wrapped in a dedicated autoreleasepool.
 // Relying on the dispatch queue to find time to drain the autoreleasepool can
 // result in significant memory creep under heavy workloads.
-VkResult MVKQueue::submit(MVKQueueSubmission* qSubmit) {
+VkResult MVKQueue::enqueue(MVKQueueSubmission* qSubmit) {
 	if (_device->getConfigurationResult() != VK_SUCCESS) { return _device->getConfigurationResult(); }
 
 	if ( !qSubmit ) { return VK_SUCCESS; }     // Ignore nils
@@ -89,11 +98,7 @@ VkResult MVKQueue::submit(MVKQueueSubmission* qSubmit) {
 		_execQueueJobCount++;
 
 		dispatch_async(_execQueue, ^{
-			execute(qSubmit);
-
-			std::unique_lock execLock(_execQueueMutex);
-			if (!--_execQueueJobCount)
-				_execQueueConditionVariable.notify_all();
+			if ( !deferUntilWaitsSignaled(qSubmit) ) { executeQueued(qSubmit); }
 		} );
 	} else {
 		rslt = execute(qSubmit);
@@ -101,41 +106,181 @@ VkResult MVKQueue::submit(MVKQueueSubmission* qSubmit) {
 	return rslt;
 }
 
-static inline uint32_t getCommandBufferCount(const VkSubmitInfo2* pSubmitInfo) { return pSubmitInfo->commandBufferInfoCount; }
-static inline uint32_t getCommandBufferCount(const VkSubmitInfo* pSubmitInfo) { return pSubmitInfo->commandBufferCount; }
+// Executes a submission that was queued on the execution dispatch queue,
+// and notifies any threads waiting for this queue to become idle.
+void MVKQueue::executeQueued(MVKQueueSubmission* qSubmit) {
+	execute(qSubmit);
+
+	std::unique_lock execLock(_execQueueMutex);
+	if (!--_execQueueJobCount)
+		_execQueueConditionVariable.notify_all();
+}
+
+// Emulated semaphores are waited on by the CPU. Rather than blocking the execution dispatch queue
+// thread until they are signaled, register to be notified when each is signaled, and suspend the
+// dispatch queue, so that later submissions remain queued behind this one, without occupying a thread.
+// The count of unsignaled waits starts with an extra count, which is removed once the dispatch queue
+// has been suspended, so that a handler cannot resume the dispatch queue before it has been suspended.
+// Returns whether execution of the submission has been deferred.
+bool MVKQueue::deferUntilWaitsSignaled(MVKQueueSubmission* qSubmit) {
+	if (qSubmit->_waitSemaphores.empty()) { return false; }
+
+	qSubmit->_unsignaledWaitCount = 1;
+	for (auto& ws : qSubmit->_waitSemaphores) {
+		qSubmit->_unsignaledWaitCount++;
+		if (ws.notifyWhenSignaled([this, qSubmit]() { signalDeferredWait(qSubmit); })) {
+			qSubmit->_unsignaledWaitCount--;
+		}
+	}
+	qSubmit->_emulatedWaitDone = true;
+
+	// If no semaphore needs to be waited on, execute now, without suspending the dispatch queue.
+	if (qSubmit->_unsignaledWaitCount == 1) { return false; }
+
+	retain();	// Keep the suspended dispatch queue alive until the deferred submission is executed.
+	dispatch_suspend(_execQueue);
+
+	// If all semaphores were signaled while being registered, execute now.
+	if (--qSubmit->_unsignaledWaitCount == 0) {
+		dispatch_resume(_execQueue);
+		release();
+		return false;
+	}
+	return true;
+}
+
+// Called as each semaphore waited on by a deferred submission is signaled. This may be called while
+// semaphore or device locks are held, so once all waits are signaled, execute the submission from
+// another thread, then resume the execution dispatch queue to allow later submissions to proceed.
+void MVKQueue::signalDeferredWait(MVKQueueSubmission* qSubmit) {
+	if (--qSubmit->_unsignaledWaitCount) { return; }
+
+	dispatch_async(dispatch_get_global_queue(dispatch_queue_get_qos_class(_execQueue, nullptr), 0), ^{
+		executeQueued(qSubmit);
+		dispatch_resume(_execQueue);
+		release();
+	});
+}
+
+// Acquires a submission from the pool, and initializes it. The submission returns itself to the pool when it finishes.
+template <typename S>
+MVKQueueCommandBufferSubmission* MVKQueue::acquireCommandBufferSubmission(const S* pSubmit, VkFence fence, MVKCommandUse cmdUse) {
+	auto* mvkSub = _commandBufferSubmissionPool->acquireObjectSafely();
+	mvkSub->init(pSubmit, fence, cmdUse);
+	return mvkSub;
+}
+
+// A submission can be merged into a batch with the preceding submissions if it has no fence
+// or semaphores, and therefore cannot be observed separately from the submissions around it.
+static inline bool mvkHasNoSync(const VkSubmitInfo2* pSubmit) {
+	return !pSubmit->flags && !pSubmit->waitSemaphoreInfoCount && !pSubmit->signalSemaphoreInfoCount;
+}
+static inline bool mvkHasNoSync(const VkSubmitInfo* pSubmit) {
+	return !pSubmit->waitSemaphoreCount && !pSubmit->signalSemaphoreCount;
+}
+
+template <typename S>
+bool MVKQueue::canBatchSubmission(const S* pSubmit, VkFence fence, MVKCommandUse cmdUse) {
+	return _submissionBatchingTimeout && !fence && cmdUse == kMVKCommandUseQueueSubmit && mvkHasNoSync(pSubmit);
+}
+
+// Adds the command buffers of the submission to the batch being held, starting a new batch if needed.
+// A new batch is submitted when the next submission that cannot be batched is made, when this
+// queue is waited on, or when the batching timeout expires, whichever comes first.
+template <typename S>
+VkResult MVKQueue::addToSubmissionBatch(const S* pSubmit, MVKCommandUse cmdUse) {
+	if (_device->getConfigurationResult() != VK_SUCCESS) { return _device->getConfigurationResult(); }
+
+	lock_guard<mutex> lock(_submissionBatchLock);
+	if (_submissionBatch) {
+		addPerformanceCount(getPerformanceStats().queue.submissionsBatched, 1);
+		return _submissionBatch->addCommandBuffers(pSubmit);
+	}
+
+	uint64_t timeout = getSubmissionBatchTimeout();
+	if ( !timeout ) { return enqueue(acquireCommandBufferSubmission(pSubmit, VK_NULL_HANDLE, cmdUse)); }
+
+	_submissionBatch = acquireCommandBufferSubmission(pSubmit, VK_NULL_HANDLE, cmdUse);
+	scheduleSubmissionBatchFlush(timeout);
+	return _submissionBatch->getConfigurationResult();
+}
+
+// Adapts the time a new batch is held to the load on the GPU. While no MTLCommandBuffers are active,
+// the GPU is idle, and holding the batch would only add latency, so it is not held at all. Otherwise,
+// the batch is held no longer than an MTLCommandBuffer typically takes to execute, because by then,
+// the work ahead of it has likely drained. As the count of active MTLCommandBuffers approaches the
+// limit of the Metal queue, the batch is held for the full batching timeout, to avoid stalling the
+// submitting thread when the next MTLCommandBuffer is retrieved from the Metal queue.
+uint64_t MVKQueue::getSubmissionBatchTimeout() {
+	uint32_t activeCnt = _activeMTLCommandBufferCount;
+	if ( !activeCnt ) { return 0; }
+	if (activeCnt >= _mtlCommandBufferPressureCount) { return _submissionBatchingTimeout; }
+
+	uint64_t avgExecTime = _averageMTLCommandBufferExecutionTime;
+	return avgExecTime ? min(avgExecTime, _submissionBatchingTimeout) : _submissionBatchingTimeout;
+}
+
+void MVKQueue::flushSubmissionBatch() {
+	if ( !_submissionBatchingTimeout ) { return; }
+
+	lock_guard<mutex> lock(_submissionBatchLock);
+	flushSubmissionBatchLocked();
+}
+
+// The caller must hold the batch lock.
+void MVKQueue::flushSubmissionBatchLocked() {
+	if ( !_submissionBatch ) { return; }
+
+	auto* qSubmit = _submissionBatch;
+	_submissionBatch = nullptr;
+	enqueue(qSubmit);
+}
+
+// Submits the batch if it is still being held when the batching timeout expires. This bounds the
+// latency of work the app waits on without making another submission, such as polling events or
+// query results. Scheduling replaces any earlier schedule of the timer, and a timer that fires after
+// its batch was already submitted finds no batch, or at worst submits a later batch early.
+// The caller must hold the batch lock.
+void MVKQueue::scheduleSubmissionBatchFlush(uint64_t timeout) {
+	bool isNewTimer = !_submissionBatchTimer;
+	if (isNewTimer) {
+		dispatch_qos_class_t qos = _execQueue ? dispatch_queue_get_qos_class(_execQueue, nullptr) : QOS_CLASS_USER_INITIATED;
+		_submissionBatchTimer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, dispatch_get_global_queue(qos, 0));
+		dispatch_source_set_event_handler(_submissionBatchTimer, ^{ flushSubmissionBatch(); });
+	}
+	dispatch_source_set_timer(_submissionBatchTimer, dispatch_time(DISPATCH_TIME_NOW, timeout), DISPATCH_TIME_FOREVER, 0);
+	if (isNewTimer) { dispatch_resume(_submissionBatchTimer); }
+}
+
+// Cancels the batch timer, and waits for any flush it is running to finish,
+// so the timer cannot access this queue once it has been destroyed.
+void MVKQueue::destroySubmissionBatchTimer() {
+	if ( !_submissionBatchTimer ) { return; }
+
+	dispatch_semaphore_t cancelSem = dispatch_semaphore_create(0);
+	dispatch_source_set_cancel_handler(_submissionBatchTimer, ^{ dispatch_semaphore_signal(cancelSem); });
+	dispatch_source_cancel(_submissionBatchTimer);
+	dispatch_semaphore_wait(cancelSem, DISPATCH_TIME_FOREVER);
+	dispatch_release(cancelSem);
+	dispatch_release(_submissionBatchTimer);
+	_submissionBatchTimer = nullptr;
+}
 
 template <typename S>
 VkResult MVKQueue::submit(uint32_t submitCount, const S* pSubmits, VkFence fence, MVKCommandUse cmdUse) {
 
     // Fence-only submission
     if (submitCount == 0 && fence) {
-        return submit(new MVKQueueCommandBufferSubmission(this, (S*)nullptr, fence, cmdUse));
+        return submit(acquireCommandBufferSubmission((S*)nullptr, fence, cmdUse));
     }
 
     VkResult rslt = VK_SUCCESS;
     for (uint32_t sIdx = 0; sIdx < submitCount; sIdx++) {
         VkFence fenceOrNil = (sIdx == (submitCount - 1)) ? fence : VK_NULL_HANDLE; // last one gets the fence
 
-		const S* pVkSub = &pSubmits[sIdx];
-		MVKQueueCommandBufferSubmission* mvkSub;
-		uint32_t cbCnt = getCommandBufferCount(pVkSub);
-		if (cbCnt <= 1) {
-			mvkSub = new MVKQueueFullCommandBufferSubmission<1>(this, pVkSub, fenceOrNil, cmdUse);
-		} else if (cbCnt <= 16) {
-			mvkSub = new MVKQueueFullCommandBufferSubmission<16>(this, pVkSub, fenceOrNil, cmdUse);
-		} else if (cbCnt <= 32) {
-			mvkSub = new MVKQueueFullCommandBufferSubmission<32>(this, pVkSub, fenceOrNil, cmdUse);
-		} else if (cbCnt <= 64) {
-			mvkSub = new MVKQueueFullCommandBufferSubmission<64>(this, pVkSub, fenceOrNil, cmdUse);
-		} else if (cbCnt <= 128) {
-			mvkSub = new MVKQueueFullCommandBufferSubmission<128>(this, pVkSub, fenceOrNil, cmdUse);
-		} else if (cbCnt <= 256) {
-			mvkSub = new MVKQueueFullCommandBufferSubmission<256>(this, pVkSub, fenceOrNil, cmdUse);
-		} else {
-			mvkSub = new MVKQueueFullCommandBufferSubmission<512>(this, pVkSub, fenceOrNil, cmdUse);
-		}
-
-        VkResult subRslt = submit(mvkSub);
+        VkResult subRslt = (canBatchSubmission(&pSubmits[sIdx], fenceOrNil, cmdUse)
+							? addToSubmissionBatch(&pSubmits[sIdx], cmdUse)
+							: submit(acquireCommandBufferSubmission(&pSubmits[sIdx], fenceOrNil, cmdUse)));
         if (rslt == VK_SUCCESS) { rslt = subRslt; }
     }
     return rslt;
@@ -146,10 +291,13 @@ template VkResult MVKQueue::submit(uint32_t submitCount, const VkSubmitInfo2* pS
 template VkResult MVKQueue::submit(uint32_t submitCount, const VkSubmitInfo* pSubmits, VkFence fence, MVKCommandUse cmdUse);
 
 VkResult MVKQueue::submit(const VkPresentInfoKHR* pPresentInfo) {
-	return submit(new MVKQueuePresentSurfaceSubmission(this, pPresentInfo));
+	auto* mvkSub = _presentSubmissionPool->acquireObjectSafely();
+	mvkSub->init(pPresentInfo);
+	return submit(mvkSub);
 }
 
 VkResult MVKQueue::waitIdle(MVKCommandUse cmdUse) {
+	flushSubmissionBatch();
 	if (_execQueue) {
 		std::unique_lock lock(_execQueueMutex);
 		while (_execQueueJobCount)
@@ -163,10 +311,21 @@ VkResult MVKQueue::waitIdle(MVKCommandUse cmdUse) {
 	return _device->getConfigurationResult();
 }
 
+// Metal blocks retrieval of a MTLCommandBuffer while the maximum number of MTLCommandBuffers are active on the
+// MTLCommandQueue. Track the number that are active, and warn the first time retrieval is about to be blocked.
 id<MTLCommandBuffer> MVKQueue::getMTLCommandBuffer(MVKCommandUse cmdUse, bool retainRefs) {
 	id<MTLCommandBuffer> mtlCmdBuff = nil;
 	uint64_t startTime = getPerformanceTimestamp();
 
+	uint32_t activeCnt = ++_activeMTLCommandBufferCount;
+	addPerformanceCount(getPerformanceStats().queue.activeMTLCommandBuffers, activeCnt);
+	if (activeCnt > _maxActiveMTLCommandBufferCount && !_hasWarnedOfMTLCommandBufferLimit.exchange(true)) {
+		MVKLogWarn("%s has reached its limit of %u active MTLCommandBuffers, and will block until one completes."
+				   " Consider increasing MVK_CONFIG_MAX_ACTIVE_METAL_COMMAND_BUFFERS_PER_QUEUE,"
+				   " or enabling MVK_CONFIG_QUEUE_SUBMISSION_BATCHING_TIMEOUT.",
+				   getName().c_str(), _maxActiveMTLCommandBufferCount);
+	}
+
 	MTLCommandBufferDescriptor* mtlCmdBuffDesc = [MTLCommandBufferDescriptor new];	// temp retain
 	mtlCmdBuffDesc.retainedReferences = retainRefs;
 	if (getMVKConfig().debugMode) {
@@ -178,12 +337,26 @@ id<MTLCommandBuffer> MVKQueue::getMTLCommandBuffer(MVKCommandUse cmdUse, bool re
 	addPerformanceInterval(getPerformanceStats().queue.retrieveMTLCommandBuffer, startTime);
 	NSString* mtlCmdBuffLabel = getMTLCommandBufferLabel(cmdUse);
 	setMetalObjectLabel(mtlCmdBuff, mtlCmdBuffLabel);
-	[mtlCmdBuff addCompletedHandler: ^(id<MTLCommandBuffer> mtlCB) { handleMTLCommandBufferError(mtlCB); }];
+	[mtlCmdBuff addCompletedHandler: ^(id<MTLCommandBuffer> mtlCB) {
+		_activeMTLCommandBufferCount--;
+		handleMTLCommandBufferError(mtlCB);
+	}];
 
-	if ( !mtlCmdBuff ) { reportError(VK_ERROR_OUT_OF_POOL_MEMORY, "%s could not be acquired.", mtlCmdBuffLabel.UTF8String); }
+	if ( !mtlCmdBuff ) {
+		_activeMTLCommandBufferCount--;
+		reportError(VK_ERROR_OUT_OF_POOL_MEMORY, "%s could not be acquired.", mtlCmdBuffLabel.UTF8String);
+	}
 	return mtlCmdBuff;
 }
 
+// Maintains a moving average of the time MTLCommandBuffers take to execute, from commit to completion.
+// Concurrent updates may occasionally drop a sample, which does not materially affect the average.
+void MVKQueue::trackMTLCommandBufferExecution(uint64_t startTime) {
+	uint64_t execTime = mvkGetElapsedNanoseconds(startTime);
+	uint64_t avgExecTime = _averageMTLCommandBufferExecutionTime;
+	_averageMTLCommandBufferExecutionTime = avgExecTime ? ((avgExecTime * 7) + execTime) / 8 : execTime;
+}
+
 NSString* MVKQueue::getMTLCommandBufferLabel(MVKCommandUse cmdUse) {
 #define CASE_GET_LABEL(cu)  \
 	case kMVKCommandUse ##cu:  \
@@ -291,6 +464,14 @@ MVKQueue::MVKQueue(MVKDevice* device, MVKQueueFamily* queueFamily, uint32_t inde
 	initName();
 	initExecQueue();
 	initMTLCommandQueue();
+
+	_submissionBatchingTimeout = getMVKConfig().queueSubmissionBatchingTimeout;
+	_maxActiveMTLCommandBufferCount = getMVKConfig().maxActiveMetalCommandBuffersPerQueue;
+	_mtlCommandBufferPressureCount = max(_maxActiveMTLCommandBufferCount * 3 / 4, 1U);
+
+	bool usePooling = getMVKConfig().useCommandPooling;
+	_commandBufferSubmissionPool = new MVKQueueSubmissionPool<MVKQueueCommandBufferSubmission>(this, usePooling);
+	_presentSubmissionPool = new MVKQueueSubmissionPool<MVKQueuePresentSurfaceSubmission>(this, usePooling);
 }
 
 void MVKQueue::initName() {
@@ -339,8 +520,17 @@ void MVKQueue::initMTLCommandQueue() {
 	_submissionCaptureScope->beginScope();	// Allow Xcode to capture the first frame if desired.
 }
 
+// Don't leave a batch of submissions being held when the app destroys this queue.
+void MVKQueue::destroy() {
+	destroySubmissionBatchTimer();
+	flushSubmissionBatch();
+	MVKDispatchableVulkanAPIObject::destroy();
+}
+
 MVKQueue::~MVKQueue() {
 	destroyExecQueue();
+	_commandBufferSubmissionPool->destroy();
+	_presentSubmissionPool->destroy();
 	_submissionCaptureScope->destroy();
 	_device->removeResidencySet(_mtlQueue);
 
@@ -373,6 +563,10 @@ void MVKSemaphoreSubmitInfo::encodeSignal(id<MTLCommandBuffer> mtlCmdBuff) {
 	if (_semaphore) { _semaphore->encodeSignal(mtlCmdBuff, value); }
 }
 
+bool MVKSemaphoreSubmitInfo::notifyWhenSignaled(std::function<void()> handler) {
+	return _semaphore ? _semaphore->notifyWhenSignaled(std::move(handler), value) : true;
+}
+
 MVKSemaphoreSubmitInfo::MVKSemaphoreSubmitInfo(const VkSemaphoreSubmitInfo& semaphoreSubmitInfo) :
 	_semaphore((MVKSemaphore*)semaphoreSubmitInfo.semaphore),
 	value(semaphoreSubmitInfo.value),
@@ -422,13 +616,10 @@ MVKCommandBufferSubmitInfo::MVKCommandBufferSubmitInfo(VkCommandBuffer commandBu
 	commandBuffer(MVKCommandBuffer::getMVKCommandBuffer(commandBuffer)),
 	deviceMask(0) {}
 
-MVKQueueSubmission::MVKQueueSubmission(MVKQueue* queue,
-									   uint32_t waitSemaphoreInfoCount,
-									   const VkSemaphoreSubmitInfo* pWaitSemaphoreSubmitInfos) : 
-	MVKBaseDeviceObject(queue->getDevice()),
-	_queue(queue) {
+void MVKQueueSubmission::initSubmission(uint32_t waitSemaphoreInfoCount,
+										const VkSemaphoreSubmitInfo* pWaitSemaphoreSubmitInfos) {
 
-	_queue->retain();	// Retain here and release in destructor. See note for MVKQueueCommandBufferSubmission::finish().
+	_queue->retain();	// Retain here and release when returned to the pool. See note for MVKQueueCommandBufferSubmission::finish().
 	_creationTime = getPerformanceTimestamp();
 
 	_waitSemaphores.reserve(waitSemaphoreInfoCount);
@@ -437,14 +628,11 @@ MVKQueueSubmission::MVKQueueSubmission(MVKQueue* queue,
 	}
 }
 
-MVKQueueSubmission::MVKQueueSubmission(MVKQueue* queue,
-									   uint32_t waitSemaphoreCount,
-									   const VkSemaphore* pWaitSemaphores,
-									   const VkPipelineStageFlags* pWaitDstStageMask) :
-	MVKBaseDeviceObject(queue->getDevice()),
-	_queue(queue) {
+void MVKQueueSubmission::initSubmission(uint32_t waitSemaphoreCount,
+										const VkSemaphore* pWaitSemaphores,
+										const VkPipelineStageFlags* pWaitDstStageMask) {
 
-	_queue->retain();	// Retain here and release in destructor. See note for MVKQueueCommandBufferSubmission::finish().
+	_queue->retain();	// Retain here and release when returned to the pool. See note for MVKQueueCommandBufferSubmission::finish().
 	_creationTime = getPerformanceTimestamp();
 
 	_waitSemaphores.reserve(waitSemaphoreCount);
@@ -453,8 +641,11 @@ MVKQueueSubmission::MVKQueueSubmission(MVKQueue* queue,
 	}
 }
 
-MVKQueueSubmission::~MVKQueueSubmission() {
-	_queue->release();
+// Releases the content of the submission, but keeps the storage for reuse by the next submission.
+void MVKQueueSubmission::resetSubmission() {
+	_waitSemaphores.clear();
+	_emulatedWaitDone = false;
+	clearConfigurationResult();
 }
 
 
@@ -545,8 +736,9 @@ VkResult MVKQueueCommandBufferSubmission::commitActiveMTLCommandBuffer(bool sign
 	id<MTLCommandBuffer> mtlCmdBuff = signalCompletion ? getActiveMTLCommandBuffer() : _activeMTLCommandBuffer;
 	_activeMTLCommandBuffer = nil;
 
-	uint64_t startTime = getPerformanceTimestamp();
+	uint64_t startTime = mvkGetTimestamp();
 	[mtlCmdBuff addCompletedHandler: ^(id<MTLCommandBuffer> mtlCB) {
+		_queue->trackMTLCommandBufferExecution(startTime);
 		addPerformanceInterval(getPerformanceStats().queue.mtlCommandBufferExecution, startTime);
 		if (signalCompletion) { this->finish(); }	// Must be the last thing the completetion callback does.
 	}];
@@ -580,22 +772,26 @@ void MVKQueueCommandBufferSubmission::finish() {
 	// If a fence exists, signal it.
 	if (_fence) { _fence->signal(); }
 
-	this->destroy();
+	// Return this instance to the pool for reuse. Release the queue last, because if the
+	// app has destroyed the queue, this may destroy it, and the pool, along with this instance.
+	MVKQueue* queue = _queue;
+	reset();
+	queue->_commandBufferSubmissionPool->returnObjectSafely(this);
+	queue->release();
 }
 
 // On device loss, the fence and signal semaphores may be signalled early, and they might then
 // be destroyed on the waiting thread before this submission is done with them. We therefore
 // retain() each here to ensure they live long enough for this submission to finish using them.
-MVKQueueCommandBufferSubmission::MVKQueueCommandBufferSubmission(MVKQueue* queue,
-																 const VkSubmitInfo2* pSubmit,
-																 VkFence fence,
-																 MVKCommandUse cmdUse) :
-	MVKQueueSubmission(queue,
-					   pSubmit ? pSubmit->waitSemaphoreInfoCount : 0,
-					   pSubmit ? pSubmit->pWaitSemaphoreInfos : nullptr),
-	_fence((MVKFence*)fence),
-	_commandUse(cmdUse) {
-	
+void MVKQueueCommandBufferSubmission::init(const VkSubmitInfo2* pSubmit,
+										   VkFence fence,
+										   MVKCommandUse cmdUse) {
+	initSubmission(pSubmit ? pSubmit->waitSemaphoreInfoCount : 0,
+				   pSubmit ? pSubmit->pWaitSemaphoreInfos : nullptr);
+
+	_fence = (MVKFence*)fence;
+	_commandUse = cmdUse;
+
 	if (_fence) { _fence->retain(); }
 
 	// pSubmit can be null if just tracking the fence alone
@@ -605,24 +801,24 @@ MVKQueueCommandBufferSubmission::MVKQueueCommandBufferSubmission(MVKQueue* queue
 		for (uint32_t i = 0; i < ssCnt; i++) {
 			_signalSemaphores.emplace_back(pSubmit->pSignalSemaphoreInfos[i]);
 		}
+
+		addCommandBuffers(pSubmit);
 	}
 }
 
 // On device loss, the fence and signal semaphores may be signalled early, and they might then
 // be destroyed on the waiting thread before this submission is done with them. We therefore
 // retain() each here to ensure they live long enough for this submission to finish using them.
-MVKQueueCommandBufferSubmission::MVKQueueCommandBufferSubmission(MVKQueue* queue,
-																 const VkSubmitInfo* pSubmit,
-																 VkFence fence,
-																 MVKCommandUse cmdUse)
-	: MVKQueueSubmission(queue,
-						 pSubmit ? pSubmit->waitSemaphoreCount : 0,
-						 pSubmit ? pSubmit->pWaitSemaphores : nullptr,
-						 pSubmit ? pSubmit->pWaitDstStageMask : nullptr),
-
-	_fence((MVKFence*)fence),
-	_commandUse(cmdUse) {
-	
+void MVKQueueCommandBufferSubmission::init(const VkSubmitInfo* pSubmit,
+										   VkFence fence,
+										   MVKCommandUse cmdUse) {
+	initSubmission(pSubmit ? pSubmit->waitSemaphoreCount : 0,
+				   pSubmit ? pSubmit->pWaitSemaphores : nullptr,
+				   pSubmit ? pSubmit->pWaitDstStageMask : nullptr);
+
+	_fence = (MVKFence*)fence;
+	_commandUse = cmdUse;
+
 	if (_fence) { _fence->retain(); }
 
     // pSubmit can be null if just tracking the fence alone
@@ -654,16 +850,51 @@ MVKQueueCommandBufferSubmission::MVKQueueCommandBufferSubmission(MVKQueue* queue
 				_signalSemaphores[i].value = pTimelineSubmit->pSignalSemaphoreValues[i];
 			}
         }
+
+		addCommandBuffers(pSubmit);
     }
 }
 
-MVKQueueCommandBufferSubmission::~MVKQueueCommandBufferSubmission() {
+VkResult MVKQueueCommandBufferSubmission::addCommandBuffers(const VkSubmitInfo2* pSubmit) {
+	VkResult rslt = VK_SUCCESS;
+	uint32_t cbCnt = pSubmit->commandBufferInfoCount;
+	for (uint32_t i = 0; i < cbCnt; i++) {
+		_cmdBuffers.emplace_back(pSubmit->pCommandBufferInfos[i]);
+		VkResult cbRslt = _cmdBuffers.back().commandBuffer->getConfigurationResult();
+		setConfigurationResult(cbRslt);
+		if (rslt == VK_SUCCESS) { rslt = cbRslt; }
+	}
+	return rslt;
+}
+
+VkResult MVKQueueCommandBufferSubmission::addCommandBuffers(const VkSubmitInfo* pSubmit) {
+	VkResult rslt = VK_SUCCESS;
+	uint32_t cbCnt = pSubmit->commandBufferCount;
+	for (uint32_t i = 0; i < cbCnt; i++) {
+		_cmdBuffers.emplace_back(pSubmit->pCommandBuffers[i]);
+		VkResult cbRslt = _cmdBuffers.back().commandBuffer->getConfigurationResult();
+		setConfigurationResult(cbRslt);
+		if (rslt == VK_SUCCESS) { rslt = cbRslt; }
+	}
+	return rslt;
+}
+
+// Releases the content of the submission, but keeps the storage for reuse by the next submission.
+void MVKQueueCommandBufferSubmission::reset() {
+	resetSubmission();
+	_cmdBuffers.clear();
+	_signalSemaphores.clear();
 	if (_fence) { _fence->release(); }
+	_fence = nullptr;
+	_encodingContext.reset();
+	_commandUse = kMVKCommandUseNone;
 }
 
+MVKQueueCommandBufferSubmission::~MVKQueueCommandBufferSubmission() {
+	if (_fence) { _fence->release(); }
+}
 
-template <size_t N>
-void MVKQueueFullCommandBufferSubmission<N>::submitCommandBuffers() {
+void MVKQueueCommandBufferSubmission::submitCommandBuffers() {
 	uint64_t startTime = getPerformanceTimestamp();
 
 	for (auto& cbInfo : _cmdBuffers) { cbInfo.commandBuffer->submit(this, &_encodingContext); }
@@ -671,40 +902,6 @@ void MVKQueueFullCommandBufferSubmission<N>::submitCommandBuffers() {
 	addPerformanceInterval(getPerformanceStats().queue.submitCommandBuffers, startTime);
 }
 
-template <size_t N>
-MVKQueueFullCommandBufferSubmission<N>::MVKQueueFullCommandBufferSubmission(MVKQueue* queue,
-																			const VkSubmitInfo2* pSubmit,
-																			VkFence fence,
-																			MVKCommandUse cmdUse)
-	: MVKQueueCommandBufferSubmission(queue, pSubmit, fence, cmdUse) {
-
-	if (pSubmit) {
-		uint32_t cbCnt = pSubmit->commandBufferInfoCount;
-		_cmdBuffers.reserve(cbCnt);
-		for (uint32_t i = 0; i < cbCnt; i++) {
-			_cmdBuffers.emplace_back(pSubmit->pCommandBufferInfos[i]);
-			setConfigurationResult(_cmdBuffers.back().commandBuffer->getConfigurationResult());
-		}
-	}
-}
-
-template <size_t N>
-MVKQueueFullCommandBufferSubmission<N>::MVKQueueFullCommandBufferSubmission(MVKQueue* queue,
-																			const VkSubmitInfo* pSubmit,
-																			VkFence fence,
-																			MVKCommandUse cmdUse)
-	: MVKQueueCommandBufferSubmission(queue, pSubmit, fence, cmdUse) {
-
-	if (pSubmit) {
-		uint32_t cbCnt = pSubmit->commandBufferCount;
-		_cmdBuffers.reserve(cbCnt);
-		for (uint32_t i = 0; i < cbCnt; i++) {
-			_cmdBuffers.emplace_back(pSubmit->pCommandBuffers[i]);
-			setConfigurationResult(_cmdBuffers.back().commandBuffer->getConfigurationResult());
-		}
-	}
-}
-
 
 #pragma mark -
 #pragma mark MVKQueuePresentSurfaceSubmission
@@ -719,8 +916,8 @@ VkResult MVKQueuePresentSurfaceSubmission::execute() {
 	id<MTLCommandBuffer> mtlCmdBuff = _queue->getMTLCommandBuffer(kMVKCommandUseQueuePresent, true);
 
 	for (auto& ws : _waitSemaphores) {
-		ws.encodeWait(mtlCmdBuff);	// Encoded semaphore waits
-		ws.encodeWait(nil);			// Inline semaphore waits
+		ws.encodeWait(mtlCmdBuff);							// Encoded semaphore waits
+		if ( !_emulatedWaitDone ) { ws.encodeWait(nil); }	// Inline semaphore waits
 	}
 
 	// Wait time from an async vkQueuePresentKHR() call to starting presentation of the swapchains
@@ -739,13 +936,15 @@ VkResult MVKQueuePresentSurfaceSubmission::execute() {
 	if ( !mtlCmdBuff ) { setConfigurationResult(VK_ERROR_OUT_OF_POOL_MEMORY); }	// Check after images may set error.
 
 	// Add completion callback to the MTLCommandBuffer to call finish(), 
-	// or if the MTLCommandBuffer could not be created, call finish() directly.
+	// or if the MTLCommandBuffer could not be created, call finish() directly,
+	// after releasing the frames counted as in flight by each swapchain.
 	// Retrieve the result first, because finish() will destroy this instance.
 	VkResult rslt = getConfigurationResult();
 	if (mtlCmdBuff) {
 		[mtlCmdBuff addCompletedHandler: ^(id<MTLCommandBuffer> mtlCB) { this->finish(); }];
 		[mtlCmdBuff commit];
 	} else {
+		for (auto& pi : _presentInfo) { pi.presentableImage->abandonPresentation(pi); }
 		finish();
 	}
 	return rslt;
@@ -763,12 +962,22 @@ void MVKQueuePresentSurfaceSubmission::finish() {
 		getDevice()->stopAutoGPUCapture(MVK_CONFIG_AUTO_GPU_CAPTURE_SCOPE_FRAME);
 	}
 
-	this->destroy();
+	// Return this instance to the pool for reuse. Release the queue last, because if the
+	// app has destroyed the queue, this may destroy it, and the pool, along with this instance.
+	MVKQueue* queue = _queue;
+	reset();
+	queue->_presentSubmissionPool->returnObjectSafely(this);
+	queue->release();
+}
+
+// Releases the content of the submission, but keeps the storage for reuse by the next submission.
+void MVKQueuePresentSurfaceSubmission::reset() {
+	resetSubmission();
+	_presentInfo.clear();
 }
 
-MVKQueuePresentSurfaceSubmission::MVKQueuePresentSurfaceSubmission(MVKQueue* queue,
-																   const VkPresentInfoKHR* pPresentInfo)
-	: MVKQueueSubmission(queue, pPresentInfo->waitSemaphoreCount, pPresentInfo->pWaitSemaphores, nullptr) {
+void MVKQueuePresentSurfaceSubmission::init(const VkPresentInfoKHR* pPresentInfo) {
+	initSubmission(pPresentInfo->waitSemaphoreCount, pPresentInfo->pWaitSemaphores, nullptr);
 
 	const VkPresentTimesInfoGOOGLE* pPresentTimesInfo = nullptr;
 	const VkSwapchainPresentFenceInfoKHR* pPresentFenceInfo = nullptr;
@@ -844,6 +1053,7 @@ MVKQueuePresentSurfaceSubmission::MVKQueuePresentSurfaceSubmission(MVKQueue* que
 			presentInfo.desiredPresentTime = pPresentTimes[scIdx].desiredPresentTime;
 		}
 		mvkSC->setLayerNeedsDisplay(pRegions ? &pRegions[scIdx] : nullptr);
+		mvkSC->notifyPresentSubmitted();
 		_presentInfo.push_back(presentInfo);
 		VkResult scRslt = mvkSC->getSurfaceStatus();
 		if (pSCRslts) { pSCRslts[scIdx] = scRslt; }
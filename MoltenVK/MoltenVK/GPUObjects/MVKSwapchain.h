@@ -100,6 +100,9 @@ public:
 	/** Marks parts of the underlying CAMetalLayer as needing update. */
 	void setLayerNeedsDisplay(const VkPresentRegionKHR* pRegion);
 
+	/** Called when a presentation of an image of this swapchain is submitted to a queue. */
+	void notifyPresentSubmitted();
+
 	void destroy() override;
 
 #pragma mark Construction
@@ -125,6 +128,8 @@ protected:
 	void endPresentation(const MVKImagePresentInfo& presentInfo, uint64_t beginPresentTime, uint64_t actualPresentTime = 0);
 	void notifyPresentComplete(const MVKImagePresentInfo& presentInfo);
 	void forceUnpresentedImageCompletion();
+	VkResult waitForFramePacing(uint64_t timeout);
+	uint64_t getFramePacingTimeout();
 
 	MVKSurface* _surface = nullptr;
     MVKWatermark* _licenseWatermark = nullptr;
@@ -136,6 +141,11 @@ protected:
 	std::mutex _presentHistoryLock;
 	std::mutex _currentPresentIdMutex;
 	std::condition_variable _currentPresentIdCondVar;
+	std::mutex _framePacingLock;
+	std::condition_variable _framePacingCondVar;
+	std::atomic<uint64_t> _averageFrameInterval = 0;
+	std::atomic<uint32_t> _framesInFlight = 0;
+	uint32_t _maxFramesInFlight = 0;
 	uint64_t _currentPresentId = 0;
 	uint64_t _lastFrameTime = 0;
 	VkExtent2D _imageExtent = {0, 0};
@@ -83,6 +83,9 @@ VkResult MVKSwapchain::acquireNextImage(uint64_t timeout,
 	if ( _device->getConfigurationResult() != VK_SUCCESS ) { return _device->getConfigurationResult(); }
 	if ( getIsSurfaceLost() ) { return VK_ERROR_SURFACE_LOST_KHR; }
 
+	VkResult pacingRslt = waitForFramePacing(timeout);
+	if (pacingRslt != VK_SUCCESS) { return pacingRslt; }
+
 	// Find the image that has the shortest wait by finding the smallest availability measure.
 	MVKPresentableSwapchainImage* minWaitImage = nullptr;
 	MVKSwapchainImageAvailability minAvailability = { kMVKUndefinedLargeUInt64, false };
@@ -113,6 +116,38 @@ VkResult MVKSwapchain::releaseImages(const VkReleaseSwapchainImagesInfoKHR* pRel
 
 uint64_t MVKSwapchain::getNextAcquisitionID() { return ++_currentAcquisitionID; }
 
+// If frame pacing is enabled, limits the number of frames in flight, by waiting to acquire the next image
+// until the number of presentations that have been submitted, but whose GPU work has not yet completed,
+// is below the limit. This keeps the app from running ahead of the GPU and display, which would add latency
+// between when the app begins a frame, and when that frame appears on the display. In case a presentation
+// never completes, the wait is bounded by a few measured frame intervals, so acquisition cannot stall.
+VkResult MVKSwapchain::waitForFramePacing(uint64_t timeout) {
+	if ( !_maxFramesInFlight || _framesInFlight < _maxFramesInFlight ) { return VK_SUCCESS; }
+	if (timeout == 0) { return VK_NOT_READY; }
+
+	uint64_t pacingTimeout = getFramePacingTimeout();
+	uint64_t startTime = getPerformanceTimestamp();
+	unique_lock<mutex> lock(_framePacingLock);
+	bool isPaced = _framePacingCondVar.wait_for(lock, chrono::nanoseconds(min(timeout, pacingTimeout)), [this] {
+		return _framesInFlight < _maxFramesInFlight || getIsSurfaceLost();
+	});
+	addPerformanceInterval(getPerformanceStats().queue.waitFramePacing, startTime);
+
+	return (isPaced || timeout > pacingTimeout) ? VK_SUCCESS : VK_TIMEOUT;
+}
+
+// Allows enough time for each frame in flight, and a couple more, to be presented at the measured
+// frame interval. Until a frame interval has been measured, a conservative fixed time is used.
+uint64_t MVKSwapchain::getFramePacingTimeout() {
+	static constexpr uint64_t kMVKDefaultFramePacingTimeout = 100 * 1000 * 1000;	// 100 ms
+	uint64_t frameInterval = _averageFrameInterval;
+	return frameInterval ? frameInterval * (_maxFramesInFlight + 2) : kMVKDefaultFramePacingTimeout;
+}
+
+void MVKSwapchain::notifyPresentSubmitted() {
+	if (_maxFramesInFlight) { _framesInFlight++; }
+}
+
 bool MVKSwapchain::getIsSurfaceLost() {
 	VkResult surfRslt = _surface->getConfigurationResult();
 	setConfigurationResult(surfRslt);
@@ -169,6 +204,10 @@ void MVKSwapchain::markFrameInterval() {
 
 	if (prevFrameTime == 0) { return; }		// First frame starts at first presentation
 
+	uint64_t frameInterval = mvkGetElapsedNanoseconds(prevFrameTime, _lastFrameTime);
+	uint64_t avgFrameInterval = _averageFrameInterval;
+	_averageFrameInterval = avgFrameInterval ? ((avgFrameInterval * 7) + frameInterval) / 8 : frameInterval;
+
 	addPerformanceInterval(getPerformanceStats().queue.frameInterval, prevFrameTime, _lastFrameTime, true);
 
 	auto& mvkCfg = getMVKConfig();
@@ -277,7 +316,14 @@ void MVKSwapchain::endPresentation(const MVKImagePresentInfo& presentInfo, uint6
 	_presentHistoryIndex = (_presentHistoryIndex + 1) % kMaxPresentationHistory;
 }
 
+// The GPU work of the frame has completed, so the frame is no longer in flight for frame pacing.
 void MVKSwapchain::notifyPresentComplete(const MVKImagePresentInfo& presentInfo) {
+	if (_maxFramesInFlight) {
+		lock_guard<mutex> lock(_framePacingLock);
+		if (_framesInFlight) { _framesInFlight--; }
+		_framePacingCondVar.notify_all();
+	}
+
 	if (presentInfo.presentId != 0) {
 		std::unique_lock pidLock(_currentPresentIdMutex);
 		_currentPresentId = std::max(_currentPresentId, presentInfo.presentId);
@@ -424,6 +470,7 @@ MVKSwapchain::MVKSwapchain(MVKDevice* device, const VkSwapchainCreateInfoKHR* pC
 	}
 
 	_isDeliberatelyScaled = pScalingInfo && pScalingInfo->scalingBehavior;
+	_maxFramesInFlight = getMVKConfig().swapchainMaxFramesInFlight;
 
 	// Set the list of present modes that can be specified in a queue
 	// present submission without causing the swapchain to be rebuilt.
@@ -22,6 +22,7 @@
 #include <atomic>
 #include <mutex>
 #include <condition_variable>
+#include <functional>
 #include <unordered_set>
 
 class MVKFenceSitter;
@@ -38,6 +39,9 @@ class MVKFenceSitter;
  * matched with a separate call to the release() function before waiting threads are
  * unblocked, or it can be configured so that a single call to the release() function
  * will release all outstanding reservations and unblock all threads immediately.
+ *
+ * The reservation count is held atomically, so status queries, reservations, and releases
+ * do not lock, unless a thread or handler is waiting for the reservations to be released.
  */
 class MVKSemaphoreImpl : public MVKBaseObject {
 
@@ -60,6 +64,12 @@ public:
 	 */
 	bool release();
 
+	/**
+	 * Releases all outstanding reservations, regardless of configuration,
+	 * and unblocks all waiting threads to continue processing.
+	 */
+	void releaseAll();
+
 	/** Returns whether this instance is in a reserved state. */
 	bool isReserved();
 
@@ -78,6 +88,20 @@ public:
 	 */
 	bool wait(uint64_t timeout = UINT64_MAX, bool reserveAgain = false);
 
+	/**
+	 * Registers a handler to be called once all outstanding reservations have been released,
+	 * as an alternative to blocking the current thread with the wait() function.
+	 *
+	 * If there are no outstanding reservations, the handler is not registered, and this function
+	 * returns true. Otherwise, this function returns false, and the handler will be called from the
+	 * thread that releases the last reservation. Because that thread may be holding other locks,
+	 * the handler should be brief, and should not call back into this instance.
+	 *
+	 * If reserveAgain is set to true, a single reservation will be added once this wait is finished,
+	 * and handlers registered after this one will remain registered until the next release.
+	 */
+	bool notifyWhenClear(std::function<void()> handler, bool reserveAgain = false);
+
 
 #pragma mark Construction
 
@@ -99,11 +123,14 @@ public:
 
 private:
 	bool operator()();
-    bool isClear() { return _reservationCount == 0; }    // Not thread-safe
+	bool isClear() { return _reservationCount.load() == 0; }		// Sequentially consistent. See release().
+	void notifyWaiters();
 
 	std::mutex _lock;
 	std::condition_variable _blocker;
-	uint32_t _reservationCount;
+	MVKSmallVector<std::pair<std::function<void()>, bool>> _clearHandlers;
+	std::atomic<uint32_t> _reservationCount;
+	std::atomic<uint32_t> _waiterCount = 0;		// Threads and handlers waiting for clear
 	bool _shouldWaitAll;
 };
 
@@ -143,6 +170,17 @@ public:
 	 */
 	virtual void encodeWait(id<MTLCommandBuffer> mtlCmdBuff, uint64_t value) = 0;
 
+	/**
+	 * Registers a handler to be called once this semaphore is signaled, as a non-blocking
+	 * alternative to calling encodeWait() with a nil mtlCmdBuff.
+	 *
+	 * Returns true if encodeWait() with a nil mtlCmdBuff would not block, because this semaphore
+	 * does not wait on the CPU, or has already been signaled, in which case the signal is consumed.
+	 * Otherwise, returns false, and the handler will be called, possibly from another thread, once
+	 * this semaphore is signaled. The handler should be brief, as it may be called while locks are held.
+	 */
+	virtual bool notifyWhenSignaled(std::function<void()> handler, uint64_t value) { return true; }
+
 	/**
 	 * Signals this semaphore.
 	 *
@@ -266,6 +304,7 @@ public:
 	void encodeSignal(id<MTLCommandBuffer> mtlCmdBuff, uint64_t) override;
 	uint64_t deferSignal() override;
 	void encodeDeferredSignal(id<MTLCommandBuffer> mtlCmdBuff, uint64_t) override;
+	bool notifyWhenSignaled(std::function<void()> handler, uint64_t) override;
 	bool isUsingCommandEncoding() override { return false; }
 
 	MVKSemaphoreEmulated(MVKDevice* device,
@@ -273,6 +312,8 @@ public:
 						 const VkExportMetalObjectCreateInfoEXT* pExportInfo,
 						 const VkImportMetalSharedEventInfoEXT* pImportInfo);
 
+	~MVKSemaphoreEmulated() override;
+
 protected:
 	MVKSemaphoreImpl _blocker;
 };
@@ -301,8 +342,12 @@ public:
 	/** Signals this semaphore on the host. */
 	virtual void signal(const VkSemaphoreSignalInfo* pSignalInfo) = 0;
 
-	/** Registers a wait for this semaphore on the host. Returns true if the semaphore is already signaled. */
-	virtual bool registerWait(MVKFenceSitter* sitter, const VkSemaphoreWaitInfo* pWaitInfo, uint32_t index) = 0;
+	/**
+	 * Registers a wait on the host for this semaphore to reach the specified value.
+	 * Returns true if the semaphore is already signaled. Each fence sitter can only
+	 * be registered once with a semaphore.
+	 */
+	virtual bool registerWait(MVKFenceSitter* sitter, uint64_t value) = 0;
 
 	/** Stops waiting for this semaphore. */
 	virtual void unregisterWait(MVKFenceSitter* sitter) = 0;
@@ -328,7 +373,7 @@ public:
 
 	uint64_t getCounterValue() override { return _mtlEvent.signaledValue; }
 	void signal(const VkSemaphoreSignalInfo* pSignalInfo) override;
-	bool registerWait(MVKFenceSitter* sitter, const VkSemaphoreWaitInfo* pWaitInfo, uint32_t index) override;
+	bool registerWait(MVKFenceSitter* sitter, uint64_t value) override;
 	void unregisterWait(MVKFenceSitter* sitter) override;
 
 	MVKTimelineSemaphoreMTLEvent(MVKDevice* device,
@@ -342,7 +387,7 @@ public:
 protected:
 	id<MTLSharedEvent> _mtlEvent = nil;
 	std::mutex _lock;
-	std::unordered_set<MVKFenceSitter*> _sitters;
+	MVKSmallVector<MVKFenceSitter*, 2> _sitters;
 };
 
 
@@ -366,12 +411,12 @@ public:
 	 * and then calls await() on the fence sitter so it is aware that it will be signaled.
 	 *
 	 * Does nothing if this fence has already been signaled, and does not call 
-	 * await() on the fence sitter.
+	 * await() on the fence sitter. Returns whether this fence has already been signaled.
 	 *
 	 * Each fence sitter should only listen once for each fence. Adding the same fence sitter
 	 * more than once in between each fence reset and signal results in undefined behaviour.
 	 */
-	void addSitter(MVKFenceSitter* fenceSitter);
+	bool addSitter(MVKFenceSitter* fenceSitter);
 
 	/** Removes the specified fence sitter. */
 	void removeSitter(MVKFenceSitter* fenceSitter);
@@ -396,15 +441,21 @@ protected:
 	void notifySitters();
 
 	std::mutex _lock;
-	std::unordered_set<MVKFenceSitter*> _fenceSitters;
-	bool _isSignaled;
+	MVKSmallVector<MVKFenceSitter*, 2> _fenceSitters;
+	std::atomic<uint32_t> _fenceSitterCount = 0;
+	std::atomic<bool> _isSignaled;
 };
 
 
 #pragma mark -
 #pragma mark MVKFenceSitter
 
-/** An object that responds to signals from MVKFences and MVKTimelineSemaphores. */
+/**
+ * An object that responds to signals from MVKFences and MVKTimelineSemaphores.
+ *
+ * A single instance can wait for any or all of many fences or semaphores. It registers
+ * with the device once, to be woken if the device is lost, rather than once per object.
+ */
 class MVKFenceSitter : public MVKBaseObject {
 
 public:
@@ -427,9 +478,14 @@ public:
 
 #pragma mark Construction
 
-	MVKFenceSitter(bool waitAll) : _blocker(waitAll, 0) {}
+	MVKFenceSitter(MVKDevice* device, bool waitAll) : _device(device), _blocker(waitAll, 0) {
+		_device->addSemaphore(&_blocker);
+	}
 
-	~MVKFenceSitter() override { [_listener release]; }
+	~MVKFenceSitter() override {
+		_device->removeSemaphore(&_blocker);
+		[_listener release];
+	}
 
 private:
 	friend class MVKFence;
@@ -440,6 +496,7 @@ private:
 	void await() { _blocker.reserve(); }
 	void signaled() { _blocker.release(); }
 
+	MVKDevice* _device;
 	MVKSemaphoreImpl _blocker;
 	MTLSharedEventListener* _listener = nil;
 };
@@ -25,54 +25,105 @@ using namespace std;
 #pragma mark -
 #pragma mark MVKSemaphoreImpl
 
+// The reservation count is updated without locking. The lock is only taken if threads or handlers
+// are waiting. Waiters increment the waiter count before testing the reservation count, and this
+// function updates the reservation count before testing the waiter count, using sequentially-consistent
+// ordering, so either this function sees the waiter, or the waiter sees the released reservation.
 bool MVKSemaphoreImpl::release() {
-	lock_guard<mutex> lock(_lock);
-    if (isClear()) { return true; }
+	// Either decrement the reservation counter, or clear it altogether
+	uint32_t rsvCnt = _reservationCount.load(memory_order_relaxed);
+	uint32_t newRsvCnt;
+	do {
+		if ( !rsvCnt ) { return true; }
+		newRsvCnt = _shouldWaitAll ? rsvCnt - 1 : 0;
+	} while ( !_reservationCount.compare_exchange_weak(rsvCnt, newRsvCnt) );
+
+	if (newRsvCnt) { return false; }
+
+	// If all reservations have been released, unblock any waiting threads and handlers
+	if (_waiterCount) { notifyWaiters(); }
+	return true;
+}
+
+// Unblocks all waiting threads, and calls the registered handlers, in order,
+// up to and including the first that reserves again.
+void MVKSemaphoreImpl::notifyWaiters() {
+	MVKSmallVector<function<void()>, 1> handlers;
+	{
+		lock_guard<mutex> lock(_lock);
+		_blocker.notify_all();
+		if (isClear()) {
+			size_t hCnt = 0;
+			for (auto& h : _clearHandlers) {
+				handlers.push_back(std::move(h.first));
+				hCnt++;
+				if (h.second) { _reservationCount++; break; }
+			}
+			_clearHandlers.erase(_clearHandlers.begin(), _clearHandlers.begin() + hCnt);
+			_waiterCount -= hCnt;
+		}
+	}
 
-    // Either decrement the reservation counter, or clear it altogether
-    if (_shouldWaitAll) {
-		if (_reservationCount > 0) { _reservationCount--; }
-    } else {
-        _reservationCount = 0;
-    }
-    // If all reservations have been released, unblock all waiting threads
-    if ( isClear() ) { _blocker.notify_all(); }
-    return isClear();
+	// Call the handlers outside the lock, in case they trigger further activity on this semaphore.
+	for (auto& h : handlers) { h(); }
+}
+
+void MVKSemaphoreImpl::releaseAll() {
+	if (_reservationCount.exchange(0) && _waiterCount) { notifyWaiters(); }
 }
 
 void MVKSemaphoreImpl::reserve() {
-	lock_guard<mutex> lock(_lock);
 	_reservationCount++;
 }
 
 bool MVKSemaphoreImpl::isReserved() {
-	lock_guard<mutex> lock(_lock);
 	return !isClear();
 }
 
 uint32_t MVKSemaphoreImpl::getReservationCount() {
-	lock_guard<mutex> lock(_lock);
-	return _reservationCount;
+	return _reservationCount.load(memory_order_acquire);
 }
 
+// A status query that does not reserve again does not need the lock. Otherwise, the semaphore is reserved
+// again while the lock is still held, so no other waiter or handler can see it as clear in between.
 bool MVKSemaphoreImpl::wait(uint64_t timeout, bool reserveAgain) {
-    unique_lock<mutex> lock(_lock);
+	if (timeout == 0 && !reserveAgain) { return isClear(); }
 
-    bool isDone;
-    if (timeout == 0) {
+	unique_lock<mutex> lock(_lock);
+	bool isDone;
+	if (timeout == 0) {
 		isDone = isClear();
-	} else if (timeout == UINT64_MAX) {
-		_blocker.wait(lock, [this]{ return isClear(); });
-		isDone = true;
 	} else {
-        // Limit timeout to avoid overflow since wait_for() uses wait_until()
-        uint64_t nanoTimeout = min(timeout, kMVKUndefinedLargeUInt64);
-        chrono::nanoseconds nanos(nanoTimeout);
-        isDone = _blocker.wait_for(lock, nanos, [this]{ return isClear(); });
-    }
+		_waiterCount++;
+		if (timeout == UINT64_MAX) {
+			_blocker.wait(lock, [this]{ return isClear(); });
+			isDone = true;
+		} else {
+			// Limit timeout to avoid overflow since wait_for() uses wait_until()
+			uint64_t nanoTimeout = min(timeout, kMVKUndefinedLargeUInt64);
+			chrono::nanoseconds nanos(nanoTimeout);
+			isDone = _blocker.wait_for(lock, nanos, [this]{ return isClear(); });
+		}
+		_waiterCount--;
+	}
 
 	if (reserveAgain) { _reservationCount++; }
-    return isDone;
+	return isDone;
+}
+
+bool MVKSemaphoreImpl::notifyWhenClear(function<void()> handler, bool reserveAgain) {
+	lock_guard<mutex> lock(_lock);
+
+	// If clear, and no other handlers are waiting their turn, the wait is already satisfied.
+	// The waiter count is incremented before testing, so a concurrent release() will see it.
+	_waiterCount++;
+	if (isClear() && _clearHandlers.empty()) {
+		_waiterCount--;
+		if (reserveAgain) { _reservationCount++; }
+		return true;
+	}
+	_clearHandlers.emplace_back(std::move(handler), reserveAgain);
+	return false;
 }
 
 MVKSemaphoreImpl::~MVKSemaphoreImpl() {
@@ -157,12 +208,14 @@ MVKSemaphoreMTLEvent::~MVKSemaphoreMTLEvent() {
 #pragma mark -
 #pragma mark MVKSemaphoreEmulated
 
+// The blocker is registered with the device for the life of this semaphore,
+// so it will be released if the device is lost, whether waits are blocking or not.
 void MVKSemaphoreEmulated::encodeWait(id<MTLCommandBuffer> mtlCmdBuff, uint64_t) {
-	if ( !mtlCmdBuff ) {
-		_device->addSemaphore(&_blocker);
-		_blocker.wait(UINT64_MAX, true);
-		_device->removeSemaphore(&_blocker);
-	}
+	if ( !mtlCmdBuff ) { _blocker.wait(UINT64_MAX, true); }
+}
+
+bool MVKSemaphoreEmulated::notifyWhenSignaled(function<void()> handler, uint64_t) {
+	return _blocker.notifyWhenClear(std::move(handler), true);
 }
 
 void MVKSemaphoreEmulated::encodeSignal(id<MTLCommandBuffer> mtlCmdBuff, uint64_t) {
@@ -187,6 +240,11 @@ MVKSemaphoreEmulated::MVKSemaphoreEmulated(MVKDevice* device,
 	if ((pImportInfo && pImportInfo->mtlSharedEvent) || (pExportInfo && pExportInfo->exportObjectType == VK_EXPORT_METAL_OBJECT_TYPE_METAL_SHARED_EVENT_BIT_EXT)) {
 		setConfigurationResult(reportError(VK_ERROR_INITIALIZATION_FAILED, "vkCreateEvent(): MTLSharedEvent is not available with VkSemaphores that use CPU emulation."));
 	}
+	_device->addSemaphore(&_blocker);
+}
+
+MVKSemaphoreEmulated::~MVKSemaphoreEmulated() {
+	_device->removeSemaphore(&_blocker);
 }
 
 
@@ -207,19 +265,18 @@ void MVKTimelineSemaphoreMTLEvent::signal(const VkSemaphoreSignalInfo* pSignalIn
 	_mtlEvent.signaledValue = pSignalInfo->value;
 }
 
-bool MVKTimelineSemaphoreMTLEvent::registerWait(MVKFenceSitter* sitter, const VkSemaphoreWaitInfo* pWaitInfo, uint32_t index) {
-	if (_mtlEvent.signaledValue >= pWaitInfo->pValues[index]) { return true; }
+bool MVKTimelineSemaphoreMTLEvent::registerWait(MVKFenceSitter* sitter, uint64_t value) {
+	if (_mtlEvent.signaledValue >= value) { return true; }
 	lock_guard<mutex> lock(_lock);
-	sitter->await();
-	auto addRslt = _sitters.insert(sitter);
-	if (addRslt.second) {
+	if ( !mvkContains(_sitters, sitter) ) {
+		sitter->await();
+		_sitters.push_back(sitter);
 		retain();
-		_device->addSemaphore(&sitter->_blocker);
 		[_mtlEvent notifyListener: sitter->getMTLSharedEventListener()
-						  atValue: pWaitInfo->pValues[index]
+						  atValue: value
 							block: ^(id<MTLSharedEvent>, uint64_t) {
 			lock_guard<mutex> blockLock(_lock);
-			if (_sitters.count(sitter)) { sitter->signaled(); }
+			if (mvkContains(_sitters, sitter)) { sitter->signaled(); }
 			release();
 		}];
 	}
@@ -228,8 +285,7 @@ bool MVKTimelineSemaphoreMTLEvent::registerWait(MVKFenceSitter* sitter, const Vk
 
 void MVKTimelineSemaphoreMTLEvent::unregisterWait(MVKFenceSitter* sitter) {
 	lock_guard<mutex> lock(_lock);
-	_device->removeSemaphore(&sitter->_blocker);
-	_sitters.erase(sitter);
+	mvkRemoveFirstOccurance(_sitters, sitter);
 }
 
 MVKTimelineSemaphoreMTLEvent::MVKTimelineSemaphoreMTLEvent(MVKDevice* device,
@@ -256,39 +312,55 @@ MVKTimelineSemaphoreMTLEvent::~MVKTimelineSemaphoreMTLEvent() {
 #pragma mark -
 #pragma mark MVKFence
 
-void MVKFence::addSitter(MVKFenceSitter* fenceSitter) {
-	lock_guard<mutex> lock(_lock);
-
+// The fence sitter count is updated before testing whether this fence is signaled, and signal() sets
+// the signaled state before testing the fence sitter count, using sequentially-consistent ordering,
+// so either signal() sees the fence sitter and notifies it, or this function sees the signal.
+bool MVKFence::addSitter(MVKFenceSitter* fenceSitter) {
 	// We only care about unsignaled fences. If already signaled,
 	// don't add myself to the sitter and don't signal the sitter.
-	if (_isSignaled) { return; }
+	if (_isSignaled) { return true; }
+
+	lock_guard<mutex> lock(_lock);
 
 	// Ensure each fence only added once to each fence sitter
-	auto addRslt = _fenceSitters.insert(fenceSitter);	// pair with second element true if was added
-	if (addRslt.second) {
-		_device->addSemaphore(&fenceSitter->_blocker);
-		fenceSitter->await();
+	if (mvkContains(_fenceSitters, fenceSitter)) { return false; }
+
+	_fenceSitters.push_back(fenceSitter);
+	_fenceSitterCount++;
+	if (_isSignaled) {
+		_fenceSitters.pop_back();
+		_fenceSitterCount--;
+		return true;
 	}
+	fenceSitter->await();
+	return false;
 }
 
+// If no fence sitters are registered, the specified fence sitter cannot be, so avoid locking.
+// While signal() is notifying fence sitters, the count remains non-zero, so this will lock and wait.
 void MVKFence::removeSitter(MVKFenceSitter* fenceSitter) {
+	if ( !_fenceSitterCount ) { return; }
+
 	lock_guard<mutex> lock(_lock);
 
-	_device->removeSemaphore(&fenceSitter->_blocker);
-	_fenceSitters.erase(fenceSitter);
+	size_t fsCnt = _fenceSitters.size();
+	mvkRemoveFirstOccurance(_fenceSitters, fenceSitter);
+	_fenceSitterCount -= (uint32_t)(fsCnt - _fenceSitters.size());
 }
 
+// Sets the signaled state without locking, and only locks if fence sitters need to be notified.
 void MVKFence::signal() {
-	lock_guard<mutex> lock(_lock);
+	if (_isSignaled.exchange(true)) { return; }	// Only signal once
+	if ( !_fenceSitterCount ) { return; }
 
-	if (_isSignaled) { return; }	// Only signal once
-	_isSignaled = true;
+	lock_guard<mutex> lock(_lock);
 
 	// Notify all the fence sitters, and clear them from this instance.
     for (auto& fs : _fenceSitters) {
         fs->signaled();
     }
 	_fenceSitters.clear();
+	_fenceSitterCount = 0;
 }
 
 void MVKFence::reset() {
@@ -296,12 +368,11 @@ void MVKFence::reset() {
 
 	_isSignaled = false;
 	_fenceSitters.clear();
+	_fenceSitterCount = 0;
 }
 
 bool MVKFence::getIsSignaled() {
-	lock_guard<mutex> lock(_lock);
-
-	return _isSignaled;
+	return _isSignaled.load(memory_order_acquire);
 }
 
 
@@ -366,7 +437,9 @@ VkResult mvkResetFences(uint32_t fenceCount, const VkFence* pFences) {
 	return VK_SUCCESS;
 }
 
-// Create a blocking fence sitter, add it to each fence, wait, then remove it.
+// Check whether the wait is already satisfied, without locking, before registering with any fences.
+// Otherwise, create a blocking fence sitter, add it to each fence, wait, then remove it.
+// When waiting for any fence, stop adding the fence sitter once a signaled fence is found.
 VkResult mvkWaitForFences(MVKDevice* device,
 						  uint32_t fenceCount,
 						  const VkFence* pFences,
@@ -377,28 +450,42 @@ VkResult mvkWaitForFences(MVKDevice* device,
 		return device->getConfigurationResult();
 	}
 
+	uint32_t sigCnt = 0;
+	for (uint32_t i = 0; i < fenceCount; i++) {
+		if (((MVKFence*)pFences[i])->getIsSignaled()) { sigCnt++; }
+	}
+	bool isDone = waitAll ? sigCnt == fenceCount : sigCnt > 0;
+	if (isDone) { return VK_SUCCESS; }
+	if (timeout == 0) { return VK_TIMEOUT; }
+
 	VkResult rslt = VK_SUCCESS;
-	MVKFenceSitter fenceSitter(waitAll);
+	MVKFenceSitter fenceSitter(device, waitAll);
 
-	for (uint32_t i = 0; i < fenceCount; i++) {
-		((MVKFence*)pFences[i])->addSitter(&fenceSitter);
+	uint32_t addCnt = 0;
+	bool alreadySignaled = false;
+	while (addCnt < fenceCount && !alreadySignaled) {
+		alreadySignaled = ((MVKFence*)pFences[addCnt++])->addSitter(&fenceSitter) && !waitAll;
 	}
 
-	bool finished = fenceSitter.wait(timeout);
+	// Don't block if the device was lost while the fence sitter was being added to the fences.
+	bool finished = (alreadySignaled ||
+					 device->getConfigurationResult() != VK_SUCCESS ||
+					 fenceSitter.wait(timeout));
 	if (device->getConfigurationResult() != VK_SUCCESS) {
 		rslt = device->getConfigurationResult();
 	} else if ( !finished ) {
 		rslt = VK_TIMEOUT;
 	}
 
-	for (uint32_t i = 0; i < fenceCount; i++) {
+	for (uint32_t i = 0; i < addCnt; i++) {
 		((MVKFence*)pFences[i])->removeSitter(&fenceSitter);
 	}
 
 	return rslt;
 }
 
-// Create a blocking fence sitter, add it to each semaphore, wait, then remove it.
+// Check whether the wait is already satisfied before registering with any semaphores.
+// Otherwise, create a blocking fence sitter, add it to each semaphore, wait, then remove it.
 VkResult mvkWaitSemaphores(MVKDevice* device,
 						   const VkSemaphoreWaitInfo* pWaitInfo,
 						   uint64_t timeout) {
@@ -407,27 +494,48 @@ VkResult mvkWaitSemaphores(MVKDevice* device,
 		return device->getConfigurationResult();
 	}
 
-	VkResult rslt = VK_SUCCESS;
 	bool waitAny = mvkIsAnyFlagEnabled(pWaitInfo->flags, VK_SEMAPHORE_WAIT_ANY_BIT);
-	bool alreadySignaled = false;
-	MVKFenceSitter fenceSitter(!waitAny);
+	uint32_t sem4Cnt = pWaitInfo->semaphoreCount;
+	uint32_t sigCnt = 0;
+	for (uint32_t i = 0; i < sem4Cnt; i++) {
+		if (((MVKTimelineSemaphore*)pWaitInfo->pSemaphores[i])->getCounterValue() >= pWaitInfo->pValues[i]) { sigCnt++; }
+	}
+	bool isDone = waitAny ? sigCnt > 0 : sigCnt == sem4Cnt;
+	if (isDone) { return VK_SUCCESS; }
+	if (timeout == 0) { return VK_TIMEOUT; }
 
-	for (uint32_t i = 0; i < pWaitInfo->semaphoreCount; i++) {
-		if (((MVKTimelineSemaphore*)pWaitInfo->pSemaphores[i])->registerWait(&fenceSitter, pWaitInfo, i) && waitAny) {
-			// In this case, we don't need to wait.
-			alreadySignaled = true;
-			break;
+	VkResult rslt = VK_SUCCESS;
+	bool alreadySignaled = false;
+	MVKFenceSitter fenceSitter(device, !waitAny);
+
+	// A semaphore may be listed more than once. Register it once, at its first occurrence, with the
+	// largest of its values for a wait-all, or the smallest of its values for a wait-any.
+	uint32_t regCnt = 0;
+	while (regCnt < sem4Cnt && !alreadySignaled) {
+		uint32_t i = regCnt++;
+		VkSemaphore vkSem4 = pWaitInfo->pSemaphores[i];
+		uint64_t value = pWaitInfo->pValues[i];
+		bool isRegistered = false;
+		for (uint32_t j = 0; j < sem4Cnt && !isRegistered; j++) {
+			if (pWaitInfo->pSemaphores[j] != vkSem4) { continue; }
+			if (j < i) { isRegistered = true; }
+			value = waitAny ? min(value, pWaitInfo->pValues[j]) : max(value, pWaitInfo->pValues[j]);
 		}
+		if (isRegistered) { continue; }
+		alreadySignaled = ((MVKTimelineSemaphore*)vkSem4)->registerWait(&fenceSitter, value) && waitAny;
 	}
 
-	bool finished = alreadySignaled || fenceSitter.wait(timeout);
+	// Don't block if the device was lost while the fence sitter was being registered.
+	bool finished = (alreadySignaled ||
+					 device->getConfigurationResult() != VK_SUCCESS ||
+					 fenceSitter.wait(timeout));
 	if (device->getConfigurationResult() != VK_SUCCESS) {
 		rslt = device->getConfigurationResult();
 	} else if ( !finished ) {
 		rslt = VK_TIMEOUT;
 	}
 
-	for (uint32_t i = 0; i < pWaitInfo->semaphoreCount; i++) {
+	for (uint32_t i = 0; i < regCnt; i++) {
 		((MVKTimelineSemaphore*)pWaitInfo->pSemaphores[i])->unregisterWait(&fenceSitter);
 	}
 
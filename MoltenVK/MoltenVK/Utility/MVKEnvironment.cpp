@@ -77,6 +77,10 @@ void mvkSetConfig(MVKConfiguration& dstMVKConfig, const MVKConfiguration& srcMVK
 	// Clamp timestampPeriodLowPassAlpha between 0.0 and 1.0.
 	dstMVKConfig.timestampPeriodLowPassAlpha = mvkClamp(dstMVKConfig.timestampPeriodLowPassAlpha, 0.0f, 1.0f);
 
+	// Limit deviceMemorySuballocationMaxSize, so each shared MTLHeap holds several allocations, and stays near its preferred size.
+	dstMVKConfig.deviceMemorySuballocationMaxSize = std::min<uint64_t>(dstMVKConfig.deviceMemorySuballocationMaxSize,
+																	   kMVKDeviceMemorySuballocationSlabSize / kMVKDeviceMemorySuballocationMinSlotCount);
+
 	// Only allow useMetalPrivateAPI to be enabled if we were built with support for it.
 	dstMVKConfig.useMetalPrivateAPI = dstMVKConfig.useMetalPrivateAPI && MVK_USE_METAL_PRIVATE_API;
 
@@ -73,6 +73,13 @@
 /** The number of members of MVKConfiguration that are strings. */
 static constexpr uint32_t kMVKConfigurationStringCount = 2;
 
+/**
+ * The preferred size of each MTLHeap shared by suballocated device memory, and the minimum number
+ * of allocations each holds, which together limit the deviceMemorySuballocationMaxSize config.
+ */
+static constexpr VkDeviceSize kMVKDeviceMemorySuballocationSlabSize = 4 * 1024 * 1024;
+static constexpr uint32_t kMVKDeviceMemorySuballocationMinSlotCount = 4;
+
 /** Global function to access MoltenVK configuration info. */
 const MVKConfiguration& getGlobalMVKConfig();
 
@@ -350,3 +357,60 @@ void mvkSetConfig(MVKConfiguration& dstMVKConfig, const MVKConfiguration& srcMVK
 #ifndef MVK_CONFIG_LIVE_CHECK_ALL_RESOURCES
 #   define MVK_CONFIG_LIVE_CHECK_ALL_RESOURCES 0
 #endif
+
+/**
+ * Drop or merge redundant dynamic state and pipeline binding commands
+ * as they are recorded into a command buffer. Disabled by default.
+ */
+#ifndef MVK_CONFIG_COMPACT_RECORDED_COMMANDS
+#   define MVK_CONFIG_COMPACT_RECORDED_COMMANDS    0
+#endif
+
+/**
+ * Create the transient renderpass and framebuffer objects of the dynamic rendering commands in reusable
+ * primary command buffers once, and reuse them on each submission. Disabled by default.
+ */
+#ifndef MVK_CONFIG_CACHE_DYNAMIC_RENDERING_OBJECTS
+#   define MVK_CONFIG_CACHE_DYNAMIC_RENDERING_OBJECTS    0
+#endif
+
+/**
+ * If set, MVK will record the helper pipeline states used by image blits and attachment clears to
+ * the manifest file at the given path, and pre-create them when the next device is created.
+ */
+#ifndef MVK_CONFIG_HELPER_PIPELINE_MANIFEST_PATH
+#   define MVK_CONFIG_HELPER_PIPELINE_MANIFEST_PATH ""
+#endif
+
+/**
+ * If set to a non-zero size, non-dedicated VkDeviceMemory allocations of up to this many bytes
+ * are carved out of larger shared MTLHeaps by a size-class allocator. Disabled by default.
+ */
+#ifndef MVK_CONFIG_DEVICE_MEMORY_SUBALLOCATION_MAX_SIZE
+#   define MVK_CONFIG_DEVICE_MEMORY_SUBALLOCATION_MAX_SIZE    0
+#endif
+
+/**
+ * If set to a non-zero number of nanoseconds, consecutive queue submissions that have no fence or
+ * semaphores are merged into a single batch, which is submitted at the next synchronization point,
+ * or after this time has elapsed. Disabled by default.
+ */
+#ifndef MVK_CONFIG_QUEUE_SUBMISSION_BATCHING_TIMEOUT
+#   define MVK_CONFIG_QUEUE_SUBMISSION_BATCHING_TIMEOUT    0
+#endif
+
+/**
+ * If set to a non-zero number, vkAcquireNextImageKHR() waits until fewer than this number of
+ * presented frames are still being processed by the GPU. Disabled by default.
+ */
+#ifndef MVK_CONFIG_SWAPCHAIN_MAX_FRAMES_IN_FLIGHT
+#   define MVK_CONFIG_SWAPCHAIN_MAX_FRAMES_IN_FLIGHT    0
+#endif
+
+/**
+ * Create the pipelines requested by a single call to vkCreateGraphicsPipelines()
+ * or vkCreateComputePipelines() concurrently. Enabled by default.
+ */
+#ifndef MVK_CONFIG_CREATE_PIPELINES_CONCURRENTLY
+#   define MVK_CONFIG_CREATE_PIPELINES_CONCURRENTLY    1
+#endif
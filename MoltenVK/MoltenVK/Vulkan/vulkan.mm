@@ -124,6 +124,19 @@ static inline void MVKTraceVulkanCallEndImpl(const char* funcName, uint64_t star
 		cmdBuff->setConfigurationResult(cmdRslt);												\
 	}
 
+// Create and configure a command whose variable-length arguments are stored inline after the command, in the
+// storage of the command buffer. The command is sized by a static newCommand() function, which takes the same
+// parameters as the setContent() function. Otherwise, this behaves the same as MVKAddCmd.
+#define MVKAddInlineCmd(cmdType, vkCmdBuff, ...)  												\
+	MVKCommandBuffer* cmdBuff = MVKCommandBuffer::getMVKCommandBuffer(vkCmdBuff);				\
+	MVKCmd ##cmdType* cmd = MVKCmd ##cmdType::newCommand(cmdBuff, ##__VA_ARGS__);				\
+	VkResult cmdRslt = cmd->setContent(cmdBuff, ##__VA_ARGS__);									\
+	if (cmdRslt == VK_SUCCESS) {																\
+		cmdBuff->addCommand(cmd);																\
+	} else {																					\
+		cmdBuff->setConfigurationResult(cmdRslt);												\
+	}
+
 // Add one of two commands, based on comparing a command parameter against a threshold value
 #define MVKAddCmdFromThreshold(baseCmdType, value, threshold, vkCmdBuff, ...)					\
 	if (value <= threshold) {																	\
@@ -533,13 +546,8 @@ MVK_PUBLIC_VULKAN_SYMBOL VkResult vkFlushMappedMemoryRanges(
     const VkMappedMemoryRange*                  pMemRanges) {
 
 	MVKTraceVulkanCallStart();
-	VkResult rslt = VK_SUCCESS;
-	for (uint32_t i = 0; i < memRangeCount; i++) {
-		const VkMappedMemoryRange* pMem = &pMemRanges[i];
-		MVKDeviceMemory* mvkMem = (MVKDeviceMemory*)pMem->memory;
-		VkResult r = mvkMem->flushToDevice(pMem->offset, pMem->size);
-		if (rslt == VK_SUCCESS) { rslt = r; }
-	}
+	MVKDevice* mvkDev = MVKDevice::getMVKDevice(device);
+	VkResult rslt = mvkDev->flushMappedMemoryRanges(memRangeCount, pMemRanges);
 	MVKTraceVulkanCallEnd();
 	return rslt;
 }
@@ -1549,13 +1557,8 @@ MVK_PUBLIC_VULKAN_SYMBOL void vkCmdBindDescriptorSets(
     const uint32_t*                             pDynamicOffsets) {
 	
 	MVKTraceVulkanCallStart();
-	if (dynamicOffsetCount) {
-		MVKAddCmdFromThreshold(BindDescriptorSetsDynamic, setCount, 4, commandBuffer, pipelineBindPoint, layout,
-				  firstSet, setCount, pDescriptorSets, dynamicOffsetCount, pDynamicOffsets);
-	} else {
-		MVKAddCmdFrom2Thresholds(BindDescriptorSetsStatic, setCount, 1, 4, commandBuffer, pipelineBindPoint, layout,
-				  firstSet, setCount, pDescriptorSets);
-	}
+	MVKAddInlineCmd(BindDescriptorSets, commandBuffer, pipelineBindPoint, layout,
+					firstSet, setCount, pDescriptorSets, dynamicOffsetCount, pDynamicOffsets);
 	MVKTraceVulkanCallEnd();
 }
 
@@ -1578,8 +1581,8 @@ MVK_PUBLIC_VULKAN_SYMBOL void vkCmdBindVertexBuffers(
     const VkDeviceSize*                         pOffsets) {
 	
 	MVKTraceVulkanCallStart();
-	MVKAddCmdFrom2Thresholds(BindVertexBuffers, bindingCount, 1, 2, commandBuffer, 
-							 firstBinding, bindingCount, pBuffers, pOffsets, nullptr, nullptr);
+	MVKAddInlineCmd(BindVertexBuffers, commandBuffer,
+					firstBinding, bindingCount, pBuffers, pOffsets, nullptr, nullptr);
 	MVKTraceVulkanCallEnd();
 }
 
@@ -2548,8 +2551,8 @@ MVK_PUBLIC_VULKAN_SYMBOL void vkCmdBindVertexBuffers2(
     const VkDeviceSize*                         pStrides) {
 
     MVKTraceVulkanCallStart();
-	MVKAddCmdFrom2Thresholds(BindVertexBuffers, bindingCount, 1, 2, commandBuffer,
-							 firstBinding, bindingCount, pBuffers, pOffsets, pSizes, pStrides);
+	MVKAddInlineCmd(BindVertexBuffers, commandBuffer,
+					firstBinding, bindingCount, pBuffers, pOffsets, pSizes, pStrides);
     MVKTraceVulkanCallEnd();
 }
 
@@ -2976,28 +2979,16 @@ MVK_PUBLIC_VULKAN_SYMBOL void vkCmdBindDescriptorSets2(
 	// the binding operation still affects all stages corresponding to the given pipeline bind point(s)
 	// as if the equivalent original version of this command had been called with the same parameters.
 	if (pBindDescriptorSetsInfo->stageFlags & VK_SHADER_STAGE_ALL_GRAPHICS) {
-		if (pBindDescriptorSetsInfo->dynamicOffsetCount) {
-			MVKAddCmdFromThreshold(BindDescriptorSetsDynamic, pBindDescriptorSetsInfo->descriptorSetCount, 4, commandBuffer,
-					VK_PIPELINE_BIND_POINT_GRAPHICS, pBindDescriptorSetsInfo->layout, pBindDescriptorSetsInfo->firstSet,
-					pBindDescriptorSetsInfo->descriptorSetCount, pBindDescriptorSetsInfo->pDescriptorSets, pBindDescriptorSetsInfo->dynamicOffsetCount,
-					pBindDescriptorSetsInfo->pDynamicOffsets);
-		} else {
-			MVKAddCmdFrom2Thresholds(BindDescriptorSetsStatic, pBindDescriptorSetsInfo->descriptorSetCount, 1, 4, commandBuffer,
-					VK_PIPELINE_BIND_POINT_GRAPHICS, pBindDescriptorSetsInfo->layout, pBindDescriptorSetsInfo->firstSet,
-					pBindDescriptorSetsInfo->descriptorSetCount, pBindDescriptorSetsInfo->pDescriptorSets);
-		}
+		MVKAddInlineCmd(BindDescriptorSets, commandBuffer,
+				VK_PIPELINE_BIND_POINT_GRAPHICS, pBindDescriptorSetsInfo->layout, pBindDescriptorSetsInfo->firstSet,
+				pBindDescriptorSetsInfo->descriptorSetCount, pBindDescriptorSetsInfo->pDescriptorSets, pBindDescriptorSetsInfo->dynamicOffsetCount,
+				pBindDescriptorSetsInfo->pDynamicOffsets);
 	}
 	if (pBindDescriptorSetsInfo->stageFlags & VK_SHADER_STAGE_COMPUTE_BIT) {
-		if (pBindDescriptorSetsInfo->dynamicOffsetCount) {
-			MVKAddCmdFromThreshold(BindDescriptorSetsDynamic, pBindDescriptorSetsInfo->descriptorSetCount, 4, commandBuffer,
-					VK_PIPELINE_BIND_POINT_COMPUTE, pBindDescriptorSetsInfo->layout, pBindDescriptorSetsInfo->firstSet,
-					pBindDescriptorSetsInfo->descriptorSetCount, pBindDescriptorSetsInfo->pDescriptorSets, pBindDescriptorSetsInfo->dynamicOffsetCount,
-					pBindDescriptorSetsInfo->pDynamicOffsets);
-		} else {
-			MVKAddCmdFrom2Thresholds(BindDescriptorSetsStatic, pBindDescriptorSetsInfo->descriptorSetCount, 1, 4, commandBuffer,
-					VK_PIPELINE_BIND_POINT_COMPUTE, pBindDescriptorSetsInfo->layout, pBindDescriptorSetsInfo->firstSet,
-					pBindDescriptorSetsInfo->descriptorSetCount, pBindDescriptorSetsInfo->pDescriptorSets);
-		}
+		MVKAddInlineCmd(BindDescriptorSets, commandBuffer,
+				VK_PIPELINE_BIND_POINT_COMPUTE, pBindDescriptorSetsInfo->layout, pBindDescriptorSetsInfo->firstSet,
+				pBindDescriptorSetsInfo->descriptorSetCount, pBindDescriptorSetsInfo->pDescriptorSets, pBindDescriptorSetsInfo->dynamicOffsetCount,
+				pBindDescriptorSetsInfo->pDynamicOffsets);
 	}
 	MVKTraceVulkanCallEnd();
 }
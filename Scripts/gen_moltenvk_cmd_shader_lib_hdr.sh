@@ -0,0 +1,81 @@
+#!/bin/bash
+
+# Compile the MoltenVK command shaders, whose MSL source is held in MVKCommandPipelineStateFactoryShaderSource.h,
+# into a Metal library, and record the library as a derived header file suitable for including in a build.
+#
+# The build fails if the command shader source does not compile. If the Metal compiler is not available,
+# an empty library is recorded, and MoltenVK will compile the command shader source at runtime instead.
+
+MVK_SHADER_SRC_FILE="${SRCROOT}/MoltenVK/Commands/MVKCommandPipelineStateFactoryShaderSource.h"
+MVK_HDR_FILE="${BUILT_PRODUCTS_DIR}/mvkCmdShaderLibDerived.h"
+MVK_TMP_DIR="${DERIVED_FILE_DIR:-${BUILT_PRODUCTS_DIR}}/mvkCmdShaderLib"
+MVK_MSL_FILE="${MVK_TMP_DIR}/MVKCmdShaders.metal"
+MVK_AIR_FILE="${MVK_TMP_DIR}/MVKCmdShaders.air"
+MVK_LIB_FILE="${MVK_TMP_DIR}/MVKCmdShaders.metallib"
+
+# The first argument is the SHA-256 hash of the MSL source, as a hex string, or empty if the MSL is not available.
+write_hdr() {
+	echo "// Auto-generated by MoltenVK" > "${MVK_HDR_FILE}"
+	echo "static const unsigned char mvkCmdShaderLibSourceHash[32] = {" >> "${MVK_HDR_FILE}"
+	echo "  $(echo "${1}" | sed -e 's/../0x&, /g' -e 's/, $//')" >> "${MVK_HDR_FILE}"
+	echo "};" >> "${MVK_HDR_FILE}"
+	echo "static const size_t mvkCmdShaderLibSize = ${2};" >> "${MVK_HDR_FILE}"
+	echo "static const unsigned char mvkCmdShaderLibData[] = {" >> "${MVK_HDR_FILE}"
+	if [ "${2}" -gt 0 ]; then
+		xxd -i < "${MVK_LIB_FILE}" >> "${MVK_HDR_FILE}"
+	else
+		echo "  0x00" >> "${MVK_HDR_FILE}"
+	fi
+	echo "};" >> "${MVK_HDR_FILE}"
+}
+
+mkdir -p "${MVK_TMP_DIR}"
+
+# The MSL source is assembled by the compiler from several string literals, so extract it by building and
+# running a small host tool that prints it. MVKDevice.h is replaced by an empty header, because the tool only
+# needs the string. A hash of the content of the MSL is recorded, to be compared at runtime against the source
+# compiled into MoltenVK, so a stale library is never used, even if edits to the source keep its size unchanged.
+MVK_STUB_DIR="${MVK_TMP_DIR}/stub"
+MVK_TOOL_SRC_FILE="${MVK_TMP_DIR}/printCmdShaderSource.mm"
+MVK_TOOL_FILE="${MVK_TMP_DIR}/printCmdShaderSource"
+mkdir -p "${MVK_STUB_DIR}"
+: > "${MVK_STUB_DIR}/MVKDevice.h"
+cat > "${MVK_TOOL_SRC_FILE}" << EOT
+#include "MVKCommandPipelineStateFactoryShaderSource.h"
+#include <stdio.h>
+int main() { fputs(_MVKStaticCmdShaderSource.UTF8String, stdout); return 0; }
+EOT
+if ! xcrun -sdk macosx clang++ -x objective-c++ -I"${MVK_STUB_DIR}" -I"${SRCROOT}/MoltenVK/Commands" -I"${SRCROOT}/MoltenVK/Utility" \
+		"${MVK_TOOL_SRC_FILE}" -framework Foundation -o "${MVK_TOOL_FILE}" || ! "${MVK_TOOL_FILE}" > "${MVK_MSL_FILE}"; then
+	echo "warning: Could not extract MoltenVK command shader source. MoltenVK command shaders will be compiled at runtime."
+	write_hdr "" 0
+	exit 0
+fi
+MVK_MSL_HASH=$(shasum -a 256 < "${MVK_MSL_FILE}" | cut -d ' ' -f 1)
+
+MVK_METAL_SDK="${PLATFORM_NAME:-macosx}"
+if ! xcrun -sdk "${MVK_METAL_SDK}" -f metal > /dev/null 2>&1; then
+	echo "warning: Metal compiler not found for ${MVK_METAL_SDK}. MoltenVK command shaders will be compiled at runtime."
+	write_hdr "${MVK_MSL_HASH}" 0
+	exit 0
+fi
+
+case "${MVK_METAL_SDK}" in
+	macosx)           MVK_MIN_OS_FLAG="-mmacosx-version-min=${MACOSX_DEPLOYMENT_TARGET}" ;;
+	iphoneos)         MVK_MIN_OS_FLAG="-mios-version-min=${IPHONEOS_DEPLOYMENT_TARGET}" ;;
+	iphonesimulator)  MVK_MIN_OS_FLAG="-mios-simulator-version-min=${IPHONEOS_DEPLOYMENT_TARGET}" ;;
+	appletvos)        MVK_MIN_OS_FLAG="-mtvos-version-min=${TVOS_DEPLOYMENT_TARGET}" ;;
+	appletvsimulator) MVK_MIN_OS_FLAG="-mtvos-simulator-version-min=${TVOS_DEPLOYMENT_TARGET}" ;;
+	*)                MVK_MIN_OS_FLAG="" ;;
+esac
+case "${MVK_MIN_OS_FLAG}" in
+	*=) MVK_MIN_OS_FLAG="" ;;
+esac
+
+if ! xcrun -sdk "${MVK_METAL_SDK}" metal ${MVK_MIN_OS_FLAG} -x metal -c "${MVK_MSL_FILE}" -o "${MVK_AIR_FILE}" ||
+   ! xcrun -sdk "${MVK_METAL_SDK}" metallib "${MVK_AIR_FILE}" -o "${MVK_LIB_FILE}"; then
+	echo "error: Could not compile MoltenVK command shaders in ${MVK_SHADER_SRC_FILE}."
+	exit 1
+fi
+
+write_hdr "${MVK_MSL_HASH}" "$(wc -c < "${MVK_LIB_FILE}" | tr -d ' ')"